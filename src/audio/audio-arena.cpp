@@ -0,0 +1,105 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+#include "audio-arena.hpp"
+
+static pthread_mutex_t arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<std::pair<float *, size_t>> free_blocks; // Protected by arena_mutex
+static audio_arena_stats_t stats = {0};                    // Protected by arena_mutex
+
+float *audio_arena_acquire(size_t floats)
+{
+    if (!floats) {
+        return nullptr;
+    }
+
+    pthread_mutex_lock(&arena_mutex);
+    for (auto it = free_blocks.begin(); it != free_blocks.end(); it++) {
+        if (it->second == floats) {
+            auto block = it->first;
+            free_blocks.erase(it);
+            stats.reused++;
+            stats.pooled--;
+            stats.in_use++;
+            pthread_mutex_unlock(&arena_mutex);
+
+            memset(block, 0, floats * sizeof(float));
+            return block;
+        }
+    }
+    stats.allocated++;
+    stats.in_use++;
+    stats.bytes += floats * sizeof(float);
+    pthread_mutex_unlock(&arena_mutex);
+
+    return (float *)bzalloc(floats * sizeof(float));
+}
+
+void audio_arena_release(float *block, size_t floats)
+{
+    if (!block) {
+        return;
+    }
+
+    pthread_mutex_lock(&arena_mutex);
+    stats.in_use--;
+    if (free_blocks.size() < AUDIO_ARENA_MAX_FREE_BLOCKS) {
+        free_blocks.push_back(std::make_pair(block, floats));
+        stats.pooled++;
+        block = nullptr;
+    } else {
+        stats.bytes -= floats * sizeof(float);
+    }
+    pthread_mutex_unlock(&arena_mutex);
+
+    bfree(block);
+}
+
+void audio_arena_free()
+{
+    pthread_mutex_lock(&arena_mutex);
+    auto blocks = std::move(free_blocks);
+    free_blocks.clear();
+    obs_log(
+        LOG_INFO, "Audio arena: allocated=%llu reused=%llu in_use=%llu", (unsigned long long)stats.allocated,
+        (unsigned long long)stats.reused, (unsigned long long)stats.in_use
+    );
+    for (auto &block : blocks) {
+        stats.bytes -= block.second * sizeof(float);
+    }
+    stats.pooled = 0;
+    pthread_mutex_unlock(&arena_mutex);
+
+    for (auto &block : blocks) {
+        bfree(block.first);
+    }
+}
+
+audio_arena_stats_t audio_arena_get_stats()
+{
+    pthread_mutex_lock(&arena_mutex);
+    auto result = stats;
+    pthread_mutex_unlock(&arena_mutex);
+    return result;
+}
@@ -0,0 +1,42 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Blocks which are kept for reuse (Per module, all sizes)
+#define AUDIO_ARENA_MAX_FREE_BLOCKS 16
+
+// Module-wide pool of audio storage blocks. Rings return their storage here instead of freeing it,
+// so restarting outputs or re-creating audio hubs with the same layout doesn't touch the heap.
+// NOTE: Never called from audio callbacks (Only when rings are initialized or freed).
+struct audio_arena_stats_t {
+    uint64_t allocated; // Blocks allocated from the heap
+    uint64_t reused;    // Blocks served from the pool
+    uint64_t in_use;    // Blocks held by rings
+    uint64_t pooled;    // Blocks kept in the pool
+    uint64_t bytes;     // Bytes of in-use and pooled blocks
+};
+
+// Returned block is zeroed
+float *audio_arena_acquire(size_t floats);
+void audio_arena_release(float *block, size_t floats);
+void audio_arena_free(); // Free every pooled block
+audio_arena_stats_t audio_arena_get_stats();
@@ -0,0 +1,359 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Headless benchmark of the audio path (Built with ENABLE_BENCHMARKS=ON, never loaded by OBS).
+// Synthetic producers write chunks into rings like audio_filter_callback and audio hubs do, and consumers drain them
+// with the same consumer steps as audio_input_callback (audio-consumer.hpp), both paced in real time.
+//
+// Usage: osi-branch-output-audio-bench [--soak <duration>]
+//   Without options: Sweep channel layouts and filter counts (A few seconds each)
+//   --soak 4h:      Run mixed layouts with many filters for the duration (s/m/h suffix), reporting periodically.
+//                   Exits with failure when any consumer overran or resynced.
+
+#include <obs-module.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <random>
+#include <vector>
+#include "audio-consumer.hpp"
+#include "audio-arena.hpp"
+#include "audio-bench.hpp"
+
+#define BENCH_SAMPLE_RATE 48000U
+// Same as MAX_AUDIO_BUFFER_FRAMES of the plugin
+#define BENCH_RING_FRAMES 131071
+#define BENCH_MAX_CHUNK_FRAMES 2048
+#define BENCH_SCENARIO_NS 3000000000ULL
+// Producer clocks run up to +/- 0.1 % off the consumer clock
+#define BENCH_CLOCK_SKEW 0.001
+// One chunk per this many jumps its timestamp (Source paused or stalled)
+#define BENCH_GAP_CHANCE 1000
+
+// Typical chunks of capture sources (e.g. 441 = 10 ms at 44.1 kHz resampled, 480 = 10 ms, 1024 = libobs tick)
+static const size_t chunk_sizes[] = {128, 441, 480, 512, 960, 1024, BENCH_MAX_CHUNK_FRAMES};
+// Mono, stereo, 5.1 and 7.1
+static const size_t channel_layouts[] = {1, 2, 6, 8};
+
+struct bench_scenario_t {
+    const char *label;
+    size_t channels; // 0: Random layout per filter
+    size_t filters;
+};
+
+static const bench_scenario_t scenarios[] = {
+    {"mono x1", 1, 1},    {"stereo x1", 2, 1}, {"5.1 x1", 6, 1},     {"7.1 x1", 8, 1},
+    {"stereo x8", 2, 8},  {"mixed x8", 0, 8},  {"stereo x32", 2, 32}, {"mixed x32", 0, 32},
+};
+
+static const bench_scenario_t soak_scenario = {"soak mixed x16", 0, 16};
+
+// Both mixers are active, so the consumer adds like audio_input_callback does with multiple tracks
+#define BENCH_MIXERS 0x3
+
+struct bench_stats_t {
+    audio_bench_histogram_t write;     // audio_ring_write() per chunk
+    audio_bench_histogram_t lock_hold; // Reader lock held per output period
+    audio_bench_histogram_t mix;       // audio_consumer_mix() per output period
+    std::atomic<uint64_t> overruns;
+    std::atomic<uint64_t> resyncs;
+    std::atomic<uint64_t> underruns;
+    std::atomic<uint64_t> gaps;
+};
+
+struct bench_filter_t {
+    audio_ring_t ring;
+    pthread_mutex_t reader_mutex; // Same as encoder group's (Consumer only tries it)
+    audio_ring_reader_t reader;
+    audio_drift_t drift;
+    size_t channels;
+    double clock_rate; // Producer speed against the consumer clock
+    uint32_t seed;
+    pthread_t producer;
+    pthread_t consumer;
+};
+
+static std::atomic<bool> running(false);
+static bench_stats_t stats;
+
+static void *producer_thread(void *data)
+{
+    os_set_thread_name("audio-bench-producer");
+    auto filter = (bench_filter_t *)data;
+    std::mt19937 rng(filter->seed);
+    std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+
+    std::vector<float> samples(MAX_AUDIO_CHANNELS * BENCH_MAX_CHUNK_FRAMES);
+    for (auto &value : samples) {
+        value = sample(rng);
+    }
+    uint8_t *planes[MAX_AUDIO_CHANNELS] = {0};
+    for (size_t ch = 0; ch < filter->channels; ch++) {
+        planes[ch] = (uint8_t *)(samples.data() + ch * BENCH_MAX_CHUNK_FRAMES);
+    }
+
+    auto start = os_gettime_ns();
+    auto timestamp = start;
+    uint64_t produced = 0;
+
+    while (running.load(std::memory_order_relaxed)) {
+        auto frames = chunk_sizes[rng() % (sizeof(chunk_sizes) / sizeof(chunk_sizes[0]))];
+
+        if (rng() % BENCH_GAP_CHANCE == 0) {
+            // 100 ms gap is padded with silence, 500 ms gap resyncs the anchor
+            timestamp += audio_frames_to_ns((uint64_t)(rng() % 2 ? 4800 : 24000), BENCH_SAMPLE_RATE);
+            stats.gaps.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto write_start = os_gettime_ns();
+        audio_ring_write(&filter->ring, planes, frames, timestamp);
+        audio_bench_record(&stats.write, os_gettime_ns() - write_start, frames);
+
+        timestamp += audio_frames_to_ns((uint64_t)frames, BENCH_SAMPLE_RATE);
+        produced += frames;
+        os_sleepto_ns(start + (uint64_t)((double)audio_frames_to_ns(produced, BENCH_SAMPLE_RATE) / filter->clock_rate));
+    }
+    return NULL;
+}
+
+// Consumer pass of audio_input_callback without libobs (Timestamps are not output)
+static void consume_once(bench_filter_t *filter, audio_output_data *mixes)
+{
+    if (pthread_mutex_trylock(&filter->reader_mutex) != 0) {
+        return;
+    }
+    auto lock_start = os_gettime_ns();
+
+    auto reader = &filter->reader;
+    auto pass = audio_consumer_prepare(reader, &filter->drift);
+    if (pass.skipped) {
+        (pass.overrun ? stats.overruns : stats.resyncs).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (pass.consume) {
+        auto mix_start = os_gettime_ns();
+        auto mix_frames = pass.consume < AUDIO_OUTPUT_FRAMES ? pass.consume : AUDIO_OUTPUT_FRAMES;
+        audio_consumer_mix(reader, filter->channels, 0, mix_frames, BENCH_MIXERS, mixes);
+        audio_bench_record(&stats.mix, os_gettime_ns() - mix_start, AUDIO_OUTPUT_FRAMES);
+
+        audio_ring_advance(reader, pass.consume);
+    } else if (pass.was_primed) {
+        stats.underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    pthread_mutex_unlock(&filter->reader_mutex);
+    audio_bench_record(&stats.lock_hold, os_gettime_ns() - lock_start, pass.consume);
+}
+
+static void *consumer_thread(void *data)
+{
+    os_set_thread_name("audio-bench-consumer");
+    auto filter = (bench_filter_t *)data;
+    std::vector<float> storage(MAX_AUDIO_MIXES * MAX_AUDIO_CHANNELS * AUDIO_OUTPUT_FRAMES);
+    audio_output_data mixes[MAX_AUDIO_MIXES];
+    for (size_t mix_idx = 0; mix_idx < MAX_AUDIO_MIXES; mix_idx++) {
+        for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+            mixes[mix_idx].data[ch] = storage.data() + (mix_idx * MAX_AUDIO_CHANNELS + ch) * AUDIO_OUTPUT_FRAMES;
+        }
+    }
+
+    auto start = os_gettime_ns();
+    uint64_t periods = 0;
+
+    while (running.load(std::memory_order_relaxed)) {
+        periods++;
+        os_sleepto_ns(start + audio_frames_to_ns(periods * AUDIO_OUTPUT_FRAMES, BENCH_SAMPLE_RATE));
+
+        // libobs clears output buffers before input callback
+        memset(storage.data(), 0, storage.size() * sizeof(float));
+        consume_once(filter, mixes);
+    }
+    return NULL;
+}
+
+// Report and reset the histograms (Histograms cover one report interval)
+static void report_histograms(const char *label)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s write", label);
+    audio_bench_report(name, &stats.write);
+    snprintf(name, sizeof(name), "%s lock hold", label);
+    audio_bench_report(name, &stats.lock_hold);
+    snprintf(name, sizeof(name), "%s mix", label);
+    audio_bench_report(name, &stats.mix);
+}
+
+// Counters cover the whole run
+static void report_counters(const char *label, const std::vector<bench_filter_t *> &filters)
+{
+    uint64_t dropped = 0;
+    uint64_t repeated = 0;
+    for (auto filter : filters) {
+        // Read while consumers run (Approximate is fine for reports)
+        dropped += filter->drift.dropped;
+        repeated += filter->drift.repeated;
+    }
+
+    obs_log(
+        LOG_INFO, "[bench] %s: dropped=%llu repeated=%llu overruns=%llu resyncs=%llu underruns=%llu gaps=%llu", label,
+        (unsigned long long)dropped, (unsigned long long)repeated,
+        (unsigned long long)stats.overruns.load(std::memory_order_relaxed),
+        (unsigned long long)stats.resyncs.load(std::memory_order_relaxed),
+        (unsigned long long)stats.underruns.load(std::memory_order_relaxed),
+        (unsigned long long)stats.gaps.load(std::memory_order_relaxed)
+    );
+}
+
+// Arena blocks allocated or reused since the scenario started, and blocks held now
+static void report_arena(const char *label, const audio_arena_stats_t *since)
+{
+    auto arena = audio_arena_get_stats();
+    obs_log(
+        LOG_INFO, "[bench] %s: Audio arena: allocated=%+lld reused=%+lld in_use=%llu pooled=%llu bytes=%llu", label,
+        (long long)(arena.allocated - since->allocated), (long long)(arena.reused - since->reused),
+        (unsigned long long)arena.in_use, (unsigned long long)arena.pooled, (unsigned long long)arena.bytes
+    );
+}
+
+// Run the scenario for the duration (Report every interval when non-zero).
+// Returns false when any consumer overran or resynced.
+static bool run_scenario(const bench_scenario_t *scenario, uint64_t duration_ns, uint64_t report_interval_ns)
+{
+    auto arena_start = audio_arena_get_stats();
+
+    std::mt19937 rng((uint32_t)os_gettime_ns());
+    std::uniform_real_distribution<double> skew(-BENCH_CLOCK_SKEW, BENCH_CLOCK_SKEW);
+
+    std::vector<bench_filter_t *> filters;
+    for (size_t i = 0; i < scenario->filters; i++) {
+        auto filter = new bench_filter_t();
+        filter->channels = scenario->channels
+                               ? scenario->channels
+                               : channel_layouts[rng() % (sizeof(channel_layouts) / sizeof(channel_layouts[0]))];
+        filter->clock_rate = 1.0 + skew(rng);
+        filter->seed = rng();
+        pthread_mutex_init(&filter->reader_mutex, NULL);
+        audio_ring_init(&filter->ring, filter->channels, BENCH_RING_FRAMES, BENCH_SAMPLE_RATE);
+        audio_ring_reader_attach(&filter->reader, &filter->ring);
+        audio_drift_reset(&filter->drift);
+        filters.push_back(filter);
+    }
+
+    stats.overruns.store(0);
+    stats.resyncs.store(0);
+    stats.underruns.store(0);
+    stats.gaps.store(0);
+
+    running.store(true);
+    for (auto filter : filters) {
+        pthread_create(&filter->producer, NULL, producer_thread, filter);
+        pthread_create(&filter->consumer, NULL, consumer_thread, filter);
+    }
+
+    auto start = os_gettime_ns();
+    auto end = start + duration_ns;
+    while (report_interval_ns) {
+        auto next = os_gettime_ns() + report_interval_ns;
+        if (next >= end) {
+            break;
+        }
+        os_sleepto_ns(next);
+        auto elapsed_s = (os_gettime_ns() - start) / 1000000000ULL;
+        obs_log(LOG_INFO, "[bench] --- %llu s elapsed", (unsigned long long)elapsed_s);
+        report_histograms(scenario->label);
+        report_counters(scenario->label, filters);
+        report_arena(scenario->label, &arena_start);
+    }
+    os_sleepto_ns(end);
+    if (report_interval_ns) {
+        obs_log(LOG_INFO, "[bench] --- end");
+    }
+
+    running.store(false);
+    for (auto filter : filters) {
+        pthread_join(filter->producer, NULL);
+        pthread_join(filter->consumer, NULL);
+    }
+
+    report_histograms(scenario->label);
+    report_counters(scenario->label, filters);
+    report_arena(scenario->label, &arena_start);
+
+    for (auto filter : filters) {
+        audio_ring_free(&filter->ring);
+        pthread_mutex_destroy(&filter->reader_mutex);
+        delete filter;
+    }
+
+    return !stats.overruns.load() && !stats.resyncs.load();
+}
+
+// "90" or "90s", "30m", "4h"
+static bool parse_duration(const char *text, uint64_t *duration_ns)
+{
+    char *suffix = NULL;
+    auto value = strtod(text, &suffix);
+    if (suffix == text || value <= 0.0) {
+        return false;
+    }
+
+    double unit = 1.0;
+    if (!strcmp(suffix, "m")) {
+        unit = 60.0;
+    } else if (!strcmp(suffix, "h")) {
+        unit = 3600.0;
+    } else if (strcmp(suffix, "") && strcmp(suffix, "s")) {
+        return false;
+    }
+
+    *duration_ns = (uint64_t)(value * unit * 1000000000.0);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t soak_ns = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--soak") && i + 1 < argc && parse_duration(argv[i + 1], &soak_ns)) {
+            i++;
+        } else {
+            fprintf(stderr, "Usage: %s [--soak <duration>] (e.g. --soak 4h)\n", argv[0]);
+            return 1;
+        }
+    }
+
+    obs_log(LOG_INFO, "[bench] Mix kernels: %s", audio_mix_init());
+
+    auto succeeded = true;
+    if (soak_ns) {
+        succeeded = run_scenario(&soak_scenario, soak_ns, AUDIO_BENCH_REPORT_INTERVAL_NS);
+        if (!succeeded) {
+            obs_log(LOG_ERROR, "[bench] Soak failed: Consumers overran or resynced");
+        }
+    } else {
+        for (auto &scenario : scenarios) {
+            run_scenario(&scenario, BENCH_SCENARIO_NS, 0);
+        }
+    }
+
+    audio_arena_free();
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <atomic>
+
+// Interval of benchmark reports (BENCHMARK_AUDIO in plugin-main.hpp, or soak runs of audio-bench.cpp)
+#define AUDIO_BENCH_REPORT_INTERVAL_NS 10000000000ULL
+// Histogram buckets of log2(ns) (Up to ~4 s)
+#define AUDIO_BENCH_BUCKETS 32
+
+// Lock-free latency histogram. Recorded on audio threads, reported and reset by one of them.
+struct audio_bench_histogram_t {
+    std::atomic<uint64_t> buckets[AUDIO_BENCH_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> total_ns;
+    std::atomic<uint64_t> max_ns;
+};
+
+inline void audio_bench_record(audio_bench_histogram_t *hist, uint64_t ns, uint64_t frames)
+{
+    size_t bucket = 0;
+    while (bucket < AUDIO_BENCH_BUCKETS - 1 && (ns >> (bucket + 1))) {
+        bucket++;
+    }
+
+    hist->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    hist->count.fetch_add(1, std::memory_order_relaxed);
+    hist->frames.fetch_add(frames, std::memory_order_relaxed);
+    hist->total_ns.fetch_add(ns, std::memory_order_relaxed);
+
+    auto max_ns = hist->max_ns.load(std::memory_order_relaxed);
+    while (ns > max_ns && !hist->max_ns.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed)) {
+    }
+}
+
+// Upper bound of the bucket which contains the percentile
+inline uint64_t audio_bench_percentile(const uint64_t *buckets, uint64_t count, double percentile)
+{
+    auto threshold = (uint64_t)((double)count * percentile);
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < AUDIO_BENCH_BUCKETS; i++) {
+        accumulated += buckets[i];
+        if (accumulated > threshold) {
+            return 2ULL << i;
+        }
+    }
+    return 2ULL << (AUDIO_BENCH_BUCKETS - 1);
+}
+
+// Log and reset the histogram (Values recorded meanwhile may go to either period)
+inline void audio_bench_report(const char *label, audio_bench_histogram_t *hist)
+{
+    uint64_t buckets[AUDIO_BENCH_BUCKETS];
+    for (size_t i = 0; i < AUDIO_BENCH_BUCKETS; i++) {
+        buckets[i] = hist->buckets[i].exchange(0, std::memory_order_relaxed);
+    }
+    auto count = hist->count.exchange(0, std::memory_order_relaxed);
+    auto frames = hist->frames.exchange(0, std::memory_order_relaxed);
+    auto total_ns = hist->total_ns.exchange(0, std::memory_order_relaxed);
+    auto max_ns = hist->max_ns.exchange(0, std::memory_order_relaxed);
+
+    if (!count) {
+        return;
+    }
+
+    obs_log(
+        LOG_INFO, "[bench] %s: calls=%llu avg=%lluns ns/frame=%.2f p50<%lluns p99<%lluns p99.9<%lluns max=%lluns",
+        label, (unsigned long long)count, (unsigned long long)(total_ns / count),
+        frames ? (double)total_ns / (double)frames : 0.0,
+        (unsigned long long)audio_bench_percentile(buckets, count, 0.5),
+        (unsigned long long)audio_bench_percentile(buckets, count, 0.99),
+        (unsigned long long)audio_bench_percentile(buckets, count, 0.999), (unsigned long long)max_ns
+    );
+}
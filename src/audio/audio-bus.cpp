@@ -0,0 +1,198 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <string>
+#include <vector>
+#include "audio-bus.hpp"
+#include "audio-drift.hpp"
+#include "audio-ring.hpp"
+
+struct audio_bus_track_t {
+    audio_input_callback_t callback; // NULL means free
+    void *param;
+    bool misaligned; // Accessed by bus callback only
+};
+
+struct audio_bus_t {
+    std::string name;
+    speaker_layout speakers;
+    uint32_t samples_per_sec;
+    size_t used; // Protected by buses_mutex
+    audio_t *output;
+
+    pthread_mutex_t tracks_mutex; // Held by bus callback while tracks are called
+    audio_bus_track_t tracks[MAX_AUDIO_MIXES];
+};
+
+static pthread_mutex_t buses_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<audio_bus_t *> buses; // Protected by buses_mutex
+static size_t bus_serial = 0;            // Protected by buses_mutex
+
+// Callback from bus's audio output
+// The window is delayed by target latency, so that producers have delivered its frames when tracks align to it.
+bool audio_bus_callback(
+    void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint64_t *out_ts, uint32_t mixers, audio_output_data *mixes
+)
+{
+    auto bus = (audio_bus_t *)param;
+    auto delay = audio_frames_to_ns((uint64_t)AUDIO_TARGET_LATENCY_FRAMES, bus->samples_per_sec);
+    auto window_ts = start_ts_in - delay;
+    *out_ts = window_ts;
+
+    pthread_mutex_lock(&bus->tracks_mutex);
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        auto track = &bus->tracks[i];
+        if (!track->callback || (mixers & (1 << i)) == 0) {
+            continue;
+        }
+
+        // Track which is waiting for audio simply stays silent
+        uint64_t track_ts = window_ts;
+        track->callback(track->param, window_ts, end_ts_in - delay, &track_ts, 1 << i, mixes);
+
+        // Tracks share the window timestamp, so output off the window is out of sync with its video
+        auto error = (int64_t)(track_ts - window_ts);
+        auto misaligned = error > AUDIO_RING_TS_TOLERANCE_NS || error < -AUDIO_RING_TS_TOLERANCE_NS;
+        if (misaligned != track->misaligned) {
+            track->misaligned = misaligned;
+            if (misaligned) {
+                obs_log(
+                    LOG_WARNING, "%s: Track %zu is off the window by %lld ms", bus->name.c_str(), i + 1,
+                    (long long)(error / 1000000)
+                );
+            } else {
+                obs_log(LOG_INFO, "%s: Track %zu is aligned again", bus->name.c_str(), i + 1);
+            }
+        }
+    }
+    pthread_mutex_unlock(&bus->tracks_mutex);
+
+    return true;
+}
+
+inline audio_bus_t *create_bus(speaker_layout speakers, uint32_t samples_per_sec)
+{
+    auto bus = new audio_bus_t();
+    bus->name = "Branch Output Audio Bus " + std::to_string(++bus_serial);
+    bus->speakers = speakers;
+    bus->samples_per_sec = samples_per_sec;
+    pthread_mutex_init(&bus->tracks_mutex, NULL);
+
+    audio_output_info oi = {0};
+    oi.name = bus->name.c_str();
+    oi.speakers = speakers;
+    oi.samples_per_sec = samples_per_sec;
+    oi.format = AUDIO_FORMAT_FLOAT_PLANAR;
+    oi.input_param = bus;
+    oi.input_callback = audio_bus_callback;
+
+    if (audio_output_open(&bus->output, &oi) < 0) {
+        obs_log(LOG_ERROR, "%s: Opening audio output failed", bus->name.c_str());
+        pthread_mutex_destroy(&bus->tracks_mutex);
+        delete bus;
+        return nullptr;
+    }
+
+    obs_log(LOG_DEBUG, "%s: Audio bus created", bus->name.c_str());
+    return bus;
+}
+
+audio_bus_t *audio_bus_acquire(
+    speaker_layout speakers, uint32_t samples_per_sec, audio_input_callback_t callback, void *param, size_t *track
+)
+{
+    pthread_mutex_lock(&buses_mutex);
+
+    audio_bus_t *bus = nullptr;
+    for (auto candidate : buses) {
+        if (candidate->speakers == speakers && candidate->samples_per_sec == samples_per_sec &&
+            candidate->used < MAX_AUDIO_MIXES) {
+            bus = candidate;
+            break;
+        }
+    }
+
+    if (!bus) {
+        bus = create_bus(speakers, samples_per_sec);
+        if (!bus) {
+            pthread_mutex_unlock(&buses_mutex);
+            return nullptr;
+        }
+        buses.push_back(bus);
+    }
+
+    pthread_mutex_lock(&bus->tracks_mutex);
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        if (!bus->tracks[i].callback) {
+            bus->tracks[i].callback = callback;
+            bus->tracks[i].param = param;
+            bus->tracks[i].misaligned = false;
+            *track = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&bus->tracks_mutex);
+    bus->used++;
+
+    obs_log(LOG_DEBUG, "%s: Track %zu assigned (%zu in use)", bus->name.c_str(), *track, bus->used);
+    pthread_mutex_unlock(&buses_mutex);
+    return bus;
+}
+
+void audio_bus_release(audio_bus_t *bus, size_t track)
+{
+    if (!bus) {
+        return;
+    }
+
+    pthread_mutex_lock(&buses_mutex);
+
+    // Waits for running callback
+    pthread_mutex_lock(&bus->tracks_mutex);
+    bus->tracks[track].callback = nullptr;
+    bus->tracks[track].param = nullptr;
+    pthread_mutex_unlock(&bus->tracks_mutex);
+
+    if (--bus->used) {
+        pthread_mutex_unlock(&buses_mutex);
+        return;
+    }
+
+    for (auto it = buses.begin(); it != buses.end(); it++) {
+        if (*it == bus) {
+            buses.erase(it);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buses_mutex);
+
+    // Bus callback never locks buses_mutex, so it's safe to join audio thread here
+    audio_output_close(bus->output);
+    pthread_mutex_destroy(&bus->tracks_mutex);
+
+    obs_log(LOG_DEBUG, "%s: Audio bus destroyed", bus->name.c_str());
+    delete bus;
+}
+
+audio_t *audio_bus_get_output(audio_bus_t *bus)
+{
+    return bus->output;
+}
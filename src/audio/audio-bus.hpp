@@ -0,0 +1,36 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Shared audio output (Bus) which carries up to MAX_AUDIO_MIXES branches on its tracks.
+// Each branch is assigned to a free track and its audio encoder is bound to the track index,
+// so audio threads grow with the number of buses instead of the number of branches.
+// Bus outputs every track at its own ticks delayed by target latency, so each track aligns its read cursor to the
+// window by capture timestamps and reports the timestamp of its output (Checked by the bus).
+struct audio_bus_t;
+
+// Callback fills mixes[track] only (Same signature as audio_output_info.input_callback, start_ts_in is the window)
+audio_bus_t *audio_bus_acquire(
+    speaker_layout speakers, uint32_t samples_per_sec, audio_input_callback_t callback, void *param, size_t *track
+);
+// Returns after running callback of the track finished
+void audio_bus_release(audio_bus_t *bus, size_t track);
+audio_t *audio_bus_get_output(audio_bus_t *bus);
@@ -0,0 +1,93 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include "audio-ring.hpp"
+#include "audio-drift.hpp"
+#include "audio-mix.hpp"
+
+// Consumer steps of a branch's audio output, shared by audio_input_callback and the headless benchmark.
+// Callers hold the reader (No locking here) and handle timestamps and counters by themselves.
+
+struct audio_consumer_pass_t {
+    size_t depth;    // Buffered frames after skipping
+    size_t skipped;  // Frames skipped because producer ran ahead
+    bool overrun;    // Producer was going to overwrite unread frames (Otherwise skipped frames are a resync)
+    bool was_primed; // Drift correction was primed before this pass
+    size_t consume;  // Frames to mix and release (0: Wait for frames)
+};
+
+// Skip frames which can't be output in time, then feed drift correction.
+inline audio_consumer_pass_t audio_consumer_prepare(audio_ring_reader_t *reader, audio_drift_t *drift)
+{
+    audio_consumer_pass_t pass = {0};
+    auto buffer_frames = audio_ring_readable(reader);
+
+    pass.overrun = audio_ring_overrun(reader, buffer_frames);
+    if (pass.overrun || buffer_frames > AUDIO_RESYNC_FRAMES) {
+        // Producer ran ahead (e.g. Output stalled) -> Skip to target latency instead of flushing whole buffer
+        pass.skipped = buffer_frames - AUDIO_TARGET_LATENCY_FRAMES;
+        audio_ring_advance(reader, pass.skipped);
+        buffer_frames = AUDIO_TARGET_LATENCY_FRAMES;
+        audio_drift_resync(drift);
+    } else if (!drift->primed && buffer_frames > AUDIO_TARGET_LATENCY_FRAMES) {
+        // Frames beyond target latency at priming are stale (Start from recent audio without adding latency)
+        audio_ring_advance(reader, buffer_frames - AUDIO_TARGET_LATENCY_FRAMES);
+        buffer_frames = AUDIO_TARGET_LATENCY_FRAMES;
+    }
+
+    pass.depth = buffer_frames;
+    pass.was_primed = drift->primed;
+    pass.consume = audio_drift_update(drift, buffer_frames);
+    return pass;
+}
+
+// Mix frames at the read cursor into active mixers after leading silence (pad).
+// Output beyond the frames repeats the last frame, so drift correction can consume one frame less.
+// NOTE: Output buffers must be blank (libobs clears them before input callback).
+inline void audio_consumer_mix(
+    audio_ring_reader_t *reader, size_t channels, size_t pad, size_t frames, uint32_t mixers, audio_output_data *mixes
+)
+{
+    // Mix directly from buffer storage
+    auto span = audio_ring_peek(reader, frames);
+
+    // Only one mixer is active (Commonly) -> Output buffer is still blank, so simply store samples.
+    auto mix_span = (mixers & (mixers - 1)) ? audio_mix_add_clamp : audio_mix_store_clamp;
+
+    for (size_t mix_idx = 0; mix_idx < MAX_AUDIO_MIXES; mix_idx++) {
+        if ((mixers & (1 << mix_idx)) == 0) {
+            continue;
+        }
+        for (size_t ch = 0; ch < channels; ch++) {
+            auto out = mixes[mix_idx].data[ch] + pad;
+            auto storage = reader->ring->data[ch];
+
+            mix_span(out, storage + span.offset, span.first_frames);
+            mix_span(out + span.first_frames, storage, span.second_frames);
+
+            // Repeat the last frame
+            auto last = storage + ((reader->read_pos + frames - 1) & reader->ring->mask);
+            for (size_t i = pad + frames; i < AUDIO_OUTPUT_FRAMES; i++) {
+                mix_span(out + (i - pad), last, 1);
+            }
+        }
+    }
+}
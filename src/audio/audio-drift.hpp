@@ -0,0 +1,97 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Buffered frames which consumer tries to keep (~85 ms at 48 kHz)
+#define AUDIO_TARGET_LATENCY_FRAMES (AUDIO_OUTPUT_FRAMES * 4)
+// Smoothed depth within (target +/- deadband) is left alone
+#define AUDIO_DRIFT_DEADBAND_FRAMES (AUDIO_OUTPUT_FRAMES / 2)
+// Depth beyond this is not drift but a stall -> Skip to target at once
+#define AUDIO_RESYNC_FRAMES (AUDIO_TARGET_LATENCY_FRAMES * 4)
+// Weight of the newest depth in moving average (1/64 = ~1.4 s at 48 kHz)
+#define AUDIO_DRIFT_SMOOTHING (1.0 / 64.0)
+// Source which never provides audio (e.g. Video only) starts with silence after this
+#define AUDIO_START_TIMEOUT_NS 1000000000ULL
+// Bus track's read cursor within jitter of the bus window is on time, within tolerance drops or repeats one frame
+// per callback and beyond it skips stale frames or pads silence at once
+#define AUDIO_ALIGN_JITTER_FRAMES (AUDIO_OUTPUT_FRAMES / 16)
+#define AUDIO_ALIGN_TOLERANCE_FRAMES (AUDIO_OUTPUT_FRAMES / 2)
+
+// Clock drift correction between audio producer (Source or filter) and consumer (Branch's audio_output).
+// Producer and consumer run on different clocks, so buffered frames slowly grow or shrink.
+// Consumer drops or repeats one frame per callback to keep buffer around the target latency,
+// which is inaudible unlike flushing whole buffer.
+struct audio_drift_t {
+    bool primed;       // Buffer reached target latency since last underrun
+    double avg_depth;  // Smoothed buffered frames
+    uint64_t dropped;  // Total dropped frames
+    uint64_t repeated; // Total repeated frames
+
+    // Output timeline (Kept across reader re-attachment)
+    bool started;        // First audio has been output
+    uint64_t wait_since; // First callback while waiting for audio
+    uint64_t next_ts;    // Timestamp of next output
+};
+
+// NOTE: Call when reader is (re)attached.
+inline void audio_drift_reset(audio_drift_t *drift)
+{
+    drift->primed = false;
+    drift->avg_depth = 0.0;
+}
+
+// Feed buffered frames and returns frames to consume in this callback:
+// AUDIO_OUTPUT_FRAMES + 1 (Drop one), AUDIO_OUTPUT_FRAMES or AUDIO_OUTPUT_FRAMES - 1 (Repeat one).
+// Returns 0 while priming (Output silence).
+inline size_t audio_drift_update(audio_drift_t *drift, size_t depth)
+{
+    if (!drift->primed) {
+        if (depth < AUDIO_TARGET_LATENCY_FRAMES) {
+            return 0;
+        }
+        drift->primed = true;
+        drift->avg_depth = (double)depth;
+    }
+
+    if (depth < AUDIO_OUTPUT_FRAMES + 1) {
+        // Underrun -> Prime again
+        drift->primed = false;
+        return 0;
+    }
+
+    drift->avg_depth += ((double)depth - drift->avg_depth) * AUDIO_DRIFT_SMOOTHING;
+
+    if (drift->avg_depth > AUDIO_TARGET_LATENCY_FRAMES + AUDIO_DRIFT_DEADBAND_FRAMES) {
+        drift->dropped++;
+        return AUDIO_OUTPUT_FRAMES + 1;
+    }
+    if (drift->avg_depth < AUDIO_TARGET_LATENCY_FRAMES - AUDIO_DRIFT_DEADBAND_FRAMES) {
+        drift->repeated++;
+        return AUDIO_OUTPUT_FRAMES - 1;
+    }
+    return AUDIO_OUTPUT_FRAMES;
+}
+
+// Consumer skipped frames to the target latency.
+inline void audio_drift_resync(audio_drift_t *drift)
+{
+    drift->avg_depth = AUDIO_TARGET_LATENCY_FRAMES;
+}
@@ -0,0 +1,174 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <map>
+#include <string>
+#include <plugin-main.hpp>
+#include "audio-hub.hpp"
+
+struct audio_hub_t {
+    std::string key;
+    long refs; // Protected by hubs_mutex
+
+    obs_weak_source_t *source; // NULL means master track
+    size_t mix_idx;
+
+    audio_ring_t ring; // Producer: Hub callback, Consumers: Filters
+};
+
+static pthread_mutex_t hubs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string, audio_hub_t *> hubs;
+
+// Callback from source's audio capture
+void hub_capture_callback(void *param, obs_source_t *, const audio_data *audio_data, bool muted)
+{
+    auto hub = (audio_hub_t *)param;
+
+    if (!audio_data->frames) {
+        return;
+    }
+
+    // Muted frames are written as silence to keep the timeline
+    uint8_t *silence[MAX_AUDIO_CHANNELS] = {0};
+    audio_ring_write(&hub->ring, muted ? silence : audio_data->data, audio_data->frames, audio_data->timestamp);
+}
+
+// Callback from master audio output
+void hub_master_callback(void *param, size_t, audio_data *audio_data)
+{
+    auto hub = (audio_hub_t *)param;
+
+    if (!audio_data->frames) {
+        return;
+    }
+
+    audio_ring_write(&hub->ring, audio_data->data, audio_data->frames, audio_data->timestamp);
+}
+
+inline audio_hub_t *find_hub(const std::string &key)
+{
+    auto it = hubs.find(key);
+    if (it == hubs.end()) {
+        return nullptr;
+    }
+    it->second->refs++;
+    return it->second;
+}
+
+inline audio_hub_t *create_hub(const std::string &key)
+{
+    auto hub = new audio_hub_t();
+    hub->key = key;
+    hub->refs = 1;
+
+    auto audio = obs_get_audio();
+    audio_ring_init(
+        &hub->ring, audio_output_get_channels(audio), MAX_AUDIO_BUFFER_FRAMES, audio_output_get_sample_rate(audio)
+    );
+
+    hubs[key] = hub;
+    return hub;
+}
+
+audio_hub_t *audio_hub_acquire_source(obs_source_t *source)
+{
+    auto key = std::string("source:") + obs_source_get_uuid(source);
+
+    pthread_mutex_lock(&hubs_mutex);
+    auto hub = find_hub(key);
+    if (!hub) {
+        hub = create_hub(key);
+        hub->source = obs_source_get_weak_source(source);
+
+        // Register audio capture callback (It forwards audio to filters)
+        obs_source_add_audio_capture_callback(source, hub_capture_callback, hub);
+        obs_log(LOG_DEBUG, "Audio hub created: %s", obs_source_get_name(source));
+    }
+    pthread_mutex_unlock(&hubs_mutex);
+
+    return hub;
+}
+
+audio_hub_t *audio_hub_acquire_master(size_t mix_idx)
+{
+    auto key = std::string("master:") + std::to_string(mix_idx);
+
+    pthread_mutex_lock(&hubs_mutex);
+    auto hub = find_hub(key);
+    if (!hub) {
+        hub = create_hub(key);
+        hub->mix_idx = mix_idx;
+
+        auto audio = obs_get_audio();
+        audio_convert_info conv = {0};
+        conv.format = AUDIO_FORMAT_FLOAT_PLANAR;
+        conv.samples_per_sec = audio_output_get_sample_rate(audio);
+        conv.speakers = (speaker_layout)audio_output_get_channels(audio);
+        conv.allow_clipping = true;
+
+        obs_add_raw_audio_callback(mix_idx, &conv, hub_master_callback, hub);
+        obs_log(LOG_DEBUG, "Audio hub created: master track %zu", mix_idx + 1);
+    }
+    pthread_mutex_unlock(&hubs_mutex);
+
+    return hub;
+}
+
+// NOTE: Readers must have stopped reading before release.
+void audio_hub_release(audio_hub_t *hub)
+{
+    if (!hub) {
+        return;
+    }
+
+    pthread_mutex_lock(&hubs_mutex);
+    auto last = --hub->refs == 0;
+    if (last) {
+        hubs.erase(hub->key);
+    }
+    pthread_mutex_unlock(&hubs_mutex);
+
+    if (!last) {
+        return;
+    }
+
+    // Unregister callback (Waits for running callback)
+    if (hub->source) {
+        auto source = obs_weak_source_get_source(hub->source);
+        if (source) {
+            obs_source_remove_audio_capture_callback(source, hub_capture_callback, hub);
+            obs_source_release(source);
+        }
+        obs_weak_source_release(hub->source);
+    } else {
+        obs_remove_raw_audio_callback(hub->mix_idx, hub_master_callback, hub);
+    }
+
+    obs_log(LOG_DEBUG, "Audio hub destroyed: %s", hub->key.c_str());
+
+    audio_ring_free(&hub->ring);
+    delete hub;
+}
+
+audio_ring_t *audio_hub_get_ring(audio_hub_t *hub)
+{
+    return &hub->ring;
+}
@@ -0,0 +1,32 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include "audio-ring.hpp"
+
+// Refcounted audio capture shared between filters.
+// Only one callback is registered per (source UUID, mix index) and its audio is published into a ring buffer
+// which every filter reads with own cursor (audio_ring_reader_t).
+struct audio_hub_t;
+
+audio_hub_t *audio_hub_acquire_source(obs_source_t *source);
+audio_hub_t *audio_hub_acquire_master(size_t mix_idx);
+void audio_hub_release(audio_hub_t *hub);
+audio_ring_t *audio_hub_get_ring(audio_hub_t *hub);
@@ -0,0 +1,195 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "audio-mix.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MIX_SSE2
+#define MIX_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MIX_TARGET_AVX2
+#else
+#define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+
+//--- Scalar kernels ---//
+
+static inline float clamp_sample(float value)
+{
+    if (value > 1.0f) {
+        return 1.0f;
+    } else if (value < -1.0f) {
+        return -1.0f;
+    }
+    return value;
+}
+
+static void mix_add_clamp_scalar(float *out, const float *in, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        out[i] = clamp_sample(out[i] + in[i]);
+    }
+}
+
+static void mix_store_clamp_scalar(float *out, const float *in, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        out[i] = clamp_sample(in[i]);
+    }
+}
+
+//--- SSE2 kernels (Baseline of x86_64) ---//
+
+#ifdef MIX_SSE2
+static void mix_add_clamp_sse2(float *out, const float *in, size_t frames)
+{
+    const auto upper = _mm_set1_ps(1.0f);
+    const auto lower = _mm_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        auto value = _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(in + i));
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_min_ps(value, upper), lower));
+    }
+    mix_add_clamp_scalar(out + i, in + i, frames - i);
+}
+
+static void mix_store_clamp_sse2(float *out, const float *in, size_t frames)
+{
+    const auto upper = _mm_set1_ps(1.0f);
+    const auto lower = _mm_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i), upper), lower));
+    }
+    mix_store_clamp_scalar(out + i, in + i, frames - i);
+}
+#endif
+
+//--- AVX2 kernels ---//
+
+#ifdef MIX_AVX2
+static MIX_TARGET_AVX2 void mix_add_clamp_avx2(float *out, const float *in, size_t frames)
+{
+    const auto upper = _mm256_set1_ps(1.0f);
+    const auto lower = _mm256_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        auto value = _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_loadu_ps(in + i));
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_min_ps(value, upper), lower));
+    }
+    mix_add_clamp_scalar(out + i, in + i, frames - i);
+}
+
+static MIX_TARGET_AVX2 void mix_store_clamp_avx2(float *out, const float *in, size_t frames)
+{
+    const auto upper = _mm256_set1_ps(1.0f);
+    const auto lower = _mm256_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(in + i), upper), lower));
+    }
+    mix_store_clamp_scalar(out + i, in + i, frames - i);
+}
+
+static inline bool cpu_supports_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // OSXSAVE and AVX, then YMM state is enabled by OS
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+//--- NEON kernels (Baseline of aarch64) ---//
+
+#ifdef MIX_NEON
+static void mix_add_clamp_neon(float *out, const float *in, size_t frames)
+{
+    const auto upper = vdupq_n_f32(1.0f);
+    const auto lower = vdupq_n_f32(-1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        auto value = vaddq_f32(vld1q_f32(out + i), vld1q_f32(in + i));
+        vst1q_f32(out + i, vmaxq_f32(vminq_f32(value, upper), lower));
+    }
+    mix_add_clamp_scalar(out + i, in + i, frames - i);
+}
+
+static void mix_store_clamp_neon(float *out, const float *in, size_t frames)
+{
+    const auto upper = vdupq_n_f32(1.0f);
+    const auto lower = vdupq_n_f32(-1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        vst1q_f32(out + i, vmaxq_f32(vminq_f32(vld1q_f32(in + i), upper), lower));
+    }
+    mix_store_clamp_scalar(out + i, in + i, frames - i);
+}
+#endif
+
+audio_mix_func_t audio_mix_add_clamp = mix_add_clamp_scalar;
+audio_mix_func_t audio_mix_store_clamp = mix_store_clamp_scalar;
+
+const char *audio_mix_init()
+{
+#if defined(MIX_AVX2)
+    if (cpu_supports_avx2()) {
+        audio_mix_add_clamp = mix_add_clamp_avx2;
+        audio_mix_store_clamp = mix_store_clamp_avx2;
+        return "AVX2";
+    }
+#endif
+#if defined(MIX_SSE2)
+    audio_mix_add_clamp = mix_add_clamp_sse2;
+    audio_mix_store_clamp = mix_store_clamp_sse2;
+    return "SSE2";
+#elif defined(MIX_NEON)
+    audio_mix_add_clamp = mix_add_clamp_neon;
+    audio_mix_store_clamp = mix_store_clamp_neon;
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
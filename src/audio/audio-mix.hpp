@@ -0,0 +1,30 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+// Mix kernels for planar float audio (Selected at runtime by audio_mix_init)
+typedef void (*audio_mix_func_t)(float *out, const float *in, size_t frames);
+
+extern audio_mix_func_t audio_mix_add_clamp;   // out = clamp(out + in, -1, 1)
+extern audio_mix_func_t audio_mix_store_clamp; // out = clamp(in, -1, 1)
+
+// Returns name of selected instruction set
+const char *audio_mix_init();
@@ -0,0 +1,278 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <atomic>
+#include "audio-arena.hpp"
+
+// Headroom for frames written by producer while a reader is mixing.
+// Readers treat the ring as full when buffered frames exceed (capacity - guard).
+#define AUDIO_RING_GUARD_FRAMES 8192
+// Frames appended by one write (Must be below the guard)
+#define AUDIO_RING_MAX_WRITE_FRAMES (AUDIO_RING_GUARD_FRAMES - 1)
+// Timestamp jitter which is not a gap or an overlap (Same as libobs audio smoothing threshold)
+#define AUDIO_RING_TS_TOLERANCE_NS 70000000LL
+// Timestamp jumps beyond this restart the timeline (e.g. Source paused)
+#define AUDIO_RING_MAX_GAP_NS 1000000000LL
+
+// Lock-free single-producer/multi-consumer ring buffer of planar float audio.
+// Channels are laid out in one storage block (From audio arena) and share the same write cursor.
+// Producer never waits for consumers, each consumer owns its read cursor (audio_ring_reader_t)
+// and detects overrun by itself.
+// Cursors are monotonic frame counters, so the storage index is (pos & mask).
+struct audio_ring_t {
+    float *storage; // Block of (channels * capacity) floats
+    float *data[MAX_AUDIO_CHANNELS];
+    size_t channels;
+    size_t capacity; // Frames per channel (Power of 2)
+    size_t mask;
+
+    std::atomic<uint64_t> write_pos; // Modified by producer only
+
+    // Producer only
+    uint32_t sample_rate;
+    uint64_t next_ts; // Expected timestamp of next write (0: None)
+
+    // Timestamp anchor: Frame at anchor_pos was captured at anchor_ts.
+    // Published by producer with a seqlock (Odd while writing), so readers never block producer.
+    std::atomic<uint32_t> anchor_seq;
+    std::atomic<uint64_t> anchor_pos;
+    std::atomic<uint64_t> anchor_ts;
+};
+
+struct audio_ring_reader_t {
+    audio_ring_t *ring;
+    uint64_t read_pos; // Accessed by owner consumer only
+};
+
+// Contiguous region of ring storage. The second part is non-empty only when the region wraps around.
+struct audio_ring_span_t {
+    size_t offset;
+    size_t first_frames;
+    size_t second_frames;
+};
+
+inline uint64_t audio_frames_to_ns(uint64_t frames, uint32_t sample_rate)
+{
+    return sample_rate ? frames * 1000000000ULL / sample_rate : 0;
+}
+
+inline size_t audio_ns_to_frames(uint64_t ns, uint32_t sample_rate)
+{
+    return (size_t)(ns * sample_rate / 1000000000ULL);
+}
+
+inline size_t audio_ring_round_capacity(size_t frames)
+{
+    size_t capacity = 1;
+    while (capacity < frames) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// NOTE: Must not be called while producer or consumers are running.
+inline void audio_ring_init(audio_ring_t *ring, size_t channels, size_t frames, uint32_t sample_rate)
+{
+    auto capacity = audio_ring_round_capacity(frames);
+
+    if (ring->channels != channels || ring->capacity != capacity) {
+        audio_arena_release(ring->storage, ring->channels * ring->capacity);
+        ring->storage = audio_arena_acquire(channels * capacity);
+        for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+            ring->data[ch] = ch < channels ? ring->storage + ch * capacity : NULL;
+        }
+        ring->channels = channels;
+        ring->capacity = capacity;
+        ring->mask = capacity - 1;
+    }
+
+    ring->write_pos.store(0);
+    ring->sample_rate = sample_rate;
+    ring->next_ts = 0;
+    ring->anchor_seq.store(0);
+    ring->anchor_pos.store(0);
+    ring->anchor_ts.store(0);
+}
+
+// NOTE: Must not be called while producer or consumers are running.
+inline void audio_ring_free(audio_ring_t *ring)
+{
+    // Storage is kept by arena for next ring
+    audio_arena_release(ring->storage, ring->channels * ring->capacity);
+    ring->storage = NULL;
+    for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+        ring->data[ch] = NULL;
+    }
+    ring->channels = 0;
+    ring->capacity = 0;
+    ring->mask = 0;
+}
+
+// Producer side: Append frames without timestamp handling. NULL channel data is written as silence.
+inline void audio_ring_write_frames(audio_ring_t *ring, uint8_t *const *data, size_t frames)
+{
+    auto write_pos = ring->write_pos.load(std::memory_order_relaxed);
+    auto start = (size_t)(write_pos & ring->mask);
+    auto first = (frames < ring->capacity - start) ? frames : ring->capacity - start;
+
+    for (size_t ch = 0; ch < ring->channels; ch++) {
+        auto dest = ring->data[ch];
+        auto src = (const float *)data[ch];
+        if (src) {
+            memcpy(dest + start, src, first * sizeof(float));
+            memcpy(dest, src + first, (frames - first) * sizeof(float));
+        } else {
+            memset(dest + start, 0, first * sizeof(float));
+            memset(dest, 0, (frames - first) * sizeof(float));
+        }
+    }
+
+    ring->write_pos.store(write_pos + frames, std::memory_order_release);
+}
+
+inline void audio_ring_store_anchor(audio_ring_t *ring, uint64_t pos, uint64_t timestamp)
+{
+    auto seq = ring->anchor_seq.load(std::memory_order_relaxed);
+    ring->anchor_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->anchor_pos.store(pos, std::memory_order_relaxed);
+    ring->anchor_ts.store(timestamp, std::memory_order_relaxed);
+    ring->anchor_seq.store(seq + 2, std::memory_order_release);
+}
+
+// Producer side: Append frames captured at the timestamp (Never blocks).
+// Short gaps are padded with silence and overlapped frames are discarded, so ring positions keep time.
+// Each write (Padding + payload) stays below the guard, so longer gaps are discontinuities which only move the anchor.
+inline void audio_ring_write(audio_ring_t *ring, uint8_t *const *data, size_t frames, uint64_t timestamp)
+{
+    if (ring->capacity <= AUDIO_RING_GUARD_FRAMES || !frames) {
+        return;
+    }
+
+    // Oversized chunk -> Keep the latest frames only
+    size_t skip = frames > AUDIO_RING_MAX_WRITE_FRAMES ? frames - AUDIO_RING_MAX_WRITE_FRAMES : 0;
+    size_t pad = 0;
+    if (ring->next_ts && ring->sample_rate) {
+        auto diff = (int64_t)(timestamp - ring->next_ts);
+        if (diff > AUDIO_RING_TS_TOLERANCE_NS && diff < AUDIO_RING_MAX_GAP_NS) {
+            pad = audio_ns_to_frames((uint64_t)diff, ring->sample_rate);
+            if (pad + frames - skip > AUDIO_RING_MAX_WRITE_FRAMES) {
+                // Too long to pad within the guard -> Resync the anchor instead
+                pad = 0;
+            }
+        } else if (diff < -AUDIO_RING_TS_TOLERANCE_NS && diff > -AUDIO_RING_MAX_GAP_NS) {
+            auto overlap = audio_ns_to_frames((uint64_t)-diff, ring->sample_rate);
+            if (overlap >= frames) {
+                // Whole chunk is stale
+                return;
+            }
+            skip = overlap > skip ? overlap : skip;
+        }
+    }
+
+    if (pad) {
+        uint8_t *silence[MAX_AUDIO_CHANNELS] = {0};
+        audio_ring_write_frames(ring, silence, pad);
+    }
+
+    uint8_t *rest[MAX_AUDIO_CHANNELS];
+    for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+        rest[ch] = ch < ring->channels && data[ch] ? data[ch] + skip * sizeof(float) : NULL;
+    }
+
+    auto pos = ring->write_pos.load(std::memory_order_relaxed);
+    auto ts = timestamp + audio_frames_to_ns(skip, ring->sample_rate);
+    audio_ring_write_frames(ring, rest, frames - skip);
+    audio_ring_store_anchor(ring, pos, ts);
+
+    ring->next_ts = timestamp + audio_frames_to_ns(frames, ring->sample_rate);
+}
+
+// Consumer side: Start reading from the latest frame.
+inline void audio_ring_reader_attach(audio_ring_reader_t *reader, audio_ring_t *ring)
+{
+    reader->ring = ring;
+    reader->read_pos = ring ? ring->write_pos.load(std::memory_order_acquire) : 0;
+}
+
+// Consumer side: Number of frames ready to read.
+inline size_t audio_ring_readable(audio_ring_reader_t *reader)
+{
+    return (size_t)(reader->ring->write_pos.load(std::memory_order_acquire) - reader->read_pos);
+}
+
+// Consumer side: Producer is going to overwrite frames which haven't been read.
+inline bool audio_ring_overrun(audio_ring_reader_t *reader, size_t readable)
+{
+    return readable > reader->ring->capacity - AUDIO_RING_GUARD_FRAMES;
+}
+
+// Consumer side: Locate frames at the read cursor without copying.
+inline audio_ring_span_t audio_ring_peek(audio_ring_reader_t *reader, size_t frames)
+{
+    auto ring = reader->ring;
+    audio_ring_span_t span;
+    span.offset = (size_t)(reader->read_pos & ring->mask);
+    span.first_frames = (frames < ring->capacity - span.offset) ? frames : ring->capacity - span.offset;
+    span.second_frames = frames - span.first_frames;
+    return span;
+}
+
+// Consumer side: Release frames which have been read.
+inline void audio_ring_advance(audio_ring_reader_t *reader, size_t frames)
+{
+    reader->read_pos += frames;
+}
+
+// Consumer side: Capture timestamp of the frame at the read cursor. Returns false until anchored.
+inline bool audio_ring_timestamp(audio_ring_reader_t *reader, uint64_t *timestamp)
+{
+    auto ring = reader->ring;
+    uint64_t pos, ts;
+
+    for (;;) {
+        auto seq = ring->anchor_seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        pos = ring->anchor_pos.load(std::memory_order_relaxed);
+        ts = ring->anchor_ts.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring->anchor_seq.load(std::memory_order_relaxed) == seq) {
+            break;
+        }
+    }
+
+    if (!ts || !ring->sample_rate) {
+        return false;
+    }
+
+    // Read cursor is usually behind the anchor
+    auto offset = (int64_t)(reader->read_pos - pos);
+    *timestamp = ts + (uint64_t)(offset * 1000000000LL / (int64_t)ring->sample_rate);
+    return true;
+}
+
+// Consumer side: Drop every buffered frame.
+inline void audio_ring_clear(audio_ring_reader_t *reader)
+{
+    reader->read_pos = reader->ring->write_pos.load(std::memory_order_acquire);
+}
@@ -18,16 +18,20 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <obs-module.h>
 #include <util/platform.h>
-#include <QGridLayout>
-#include <QLabel>
 #include <QTimer>
 #include <QString>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
 #include <QHeaderView>
+#include <QScrollBar>
 #include <QPushButton>
+#include <QLabel>
 #include <QHBoxLayout>
-#include <QCheckBox>
+#include <QVBoxLayout>
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionButton>
+#include <algorithm>
 #include <plugin-main.hpp>
 #include "output-status.hpp"
 
@@ -38,329 +42,537 @@ extern "C" {
 extern void obs_log(int log_level, const char *format, ...);
 }
 
-BranchOutputStatus::BranchOutputStatus(QWidget *parent) : QFrame(parent), timer(this)
+// Compare and assign, then returns true when the value changed.
+template<class T> static inline bool update_value(T &dst, const T &src)
 {
-    setMinimumWidth(320);
-
-    // Setup statistics table
-    outputTable = new QTableWidget(this);
-    outputTable->verticalHeader()->hide();
-    outputTable->horizontalHeader()->setSectionsClickable(false);
-    outputTable->horizontalHeader()->setMinimumSectionSize(100);
-    outputTable->setGridStyle(Qt::NoPen);
-    outputTable->setHorizontalScrollMode(QTableView::ScrollMode::ScrollPerPixel);
-    outputTable->setVerticalScrollMode(QTableView::ScrollMode::ScrollPerPixel);
-    outputTable->setSelectionMode(QTableWidget::SelectionMode::NoSelection);
-    outputTable->setFocusPolicy(Qt::FocusPolicy::NoFocus);
-    outputTable->setColumnCount(7);
-
-    int col = 0;
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("FilterName")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("SourceName")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("Status")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("DropFrames")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("SentDataSize")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("BitRate")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QString::fromUtf8("")));
-
-    QObject::connect(&timer, &QTimer::timeout, this, &BranchOutputStatus::Update);
-
-    timer.setInterval(TIMER_INTERVAL);
-    if (isVisible()) {
-        timer.start();
+    if (dst == src) {
+        return false;
     }
+    dst = src;
+    return true;
+}
 
-    // Tool buttons
-    auto enableAllButton = new QPushButton(QTStr("EnableAll"));
-    connect(enableAllButton, &QPushButton::clicked, [this]() { SetEabnleAll(true); });
-
-    auto disableAllButton = new QPushButton(QTStr("DisableAll"));
-    connect(disableAllButton, &QPushButton::clicked, [this]() { SetEabnleAll(false); });
+// OutputStatusModel class
 
-    auto buttonsContainerLayout = new QHBoxLayout();
-    buttonsContainerLayout->addWidget(enableAllButton);
-    buttonsContainerLayout->addWidget(disableAllButton);
-    buttonsContainerLayout->addStretch();
+OutputStatusModel::OutputStatusModel(QObject *parent) : QAbstractTableModel(parent) {}
 
-    QVBoxLayout *outputContainerLayout = new QVBoxLayout();
-    outputContainerLayout->addWidget(outputTable);
-    outputContainerLayout->addLayout(buttonsContainerLayout);
-    this->setLayout(outputContainerLayout);
+int OutputStatusModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : (int)rows.size();
 }
 
-BranchOutputStatus::~BranchOutputStatus() {}
-
-void BranchOutputStatus::AddFilter(filter_t *filter)
+int OutputStatusModel::columnCount(const QModelIndex &parent) const
 {
-    auto parent = obs_filter_get_parent(filter->source);
-    auto row = (int)outputLabels.size();
-
-    OutputLabels ol;
-
-    ol.filter = filter;
-    ol.filterCell = new FilterCell(QString::fromUtf8(obs_source_get_name(filter->source)), filter->source, this);
-    ol.parentCell = new ParentCell(QString::fromUtf8(obs_source_get_name(parent)), parent, this);
-    ol.status = new QLabel(QTStr("Status.Inactive"), this);
-    ol.droppedFrames = new QLabel(QString::fromUtf8(""), this);
-    ol.megabytesSent = new QLabel(QString::fromUtf8(""), this);
-    ol.bitrate = new QLabel(QString::fromUtf8(""), this);
-
-    outputLabels.push_back(ol);
-
-    auto col = 0;
-    outputTable->setRowCount(row + 1);
-    outputTable->setCellWidget(row, col++, ol.filterCell);
-    outputTable->setCellWidget(row, col++, ol.parentCell);
-    outputTable->setCellWidget(row, col++, ol.status);
-    outputTable->setCellWidget(row, col++, ol.droppedFrames);
-    outputTable->setCellWidget(row, col++, ol.megabytesSent);
-    outputTable->setCellWidget(row, col++, ol.bitrate);
-
-    outputTable->setRowHeight(row, 32);
-
-    // Setup reset button
-    auto resetButtonContainer = new QWidget(this);
-    auto resetButtonContainerLayout = new QHBoxLayout();
-    resetButtonContainerLayout->setContentsMargins(0, 0, 0, 0);
-    resetButtonContainer->setLayout(resetButtonContainerLayout);
-
-    auto resetButton = new QPushButton(QTStr("Reset"), this);
-    connect(resetButton, &QPushButton::clicked, [this, row]() { outputLabels[row].Reset(); });
-    resetButton->setProperty("toolButton", true);
-    resetButton->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
-
-    resetButtonContainerLayout->addWidget(resetButton);
-    outputTable->setCellWidget(row, col, resetButtonContainer);
+    return parent.isValid() ? 0 : COLUMN_COUNT;
 }
 
-void BranchOutputStatus::RemoveFilter(filter_t *filter)
+QVariant OutputStatusModel::data(const QModelIndex &index, int role) const
 {
-    for (int i = 0; i < outputLabels.size(); i++) {
-        if (outputLabels[i].filter == filter) {
-            outputLabels.removeAt(i);
-            outputTable->removeRow(i);
-            break;
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+
+    auto &row = rows[index.row()];
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case COLUMN_FILTER:
+            if (row.recording) {
+                return QString("%1 (%2)").arg(row.filterName, QTStr("Recording"));
+            }
+            return row.index ? QString("%1 #%2").arg(row.filterName).arg(row.index + 1) : row.filterName;
+        case COLUMN_SOURCE:
+            return row.parentName;
+        case COLUMN_STATUS:
+            return row.status;
+        case COLUMN_DROPPED_FRAMES:
+            return row.droppedFrames;
+        case COLUMN_SENT_SIZE:
+            return row.megabytesSent;
+        case COLUMN_BITRATE:
+            return row.bitrate;
+        case COLUMN_RESET:
+            return QTStr("Reset");
         }
+        break;
+    case Qt::CheckStateRole:
+        if (index.column() == COLUMN_FILTER) {
+            return row.enabled ? Qt::Checked : Qt::Unchecked;
+        }
+        break;
+    case ThemeRole:
+        if (index.column() == COLUMN_STATUS) {
+            return (int)row.statusTheme;
+        } else if (index.column() == COLUMN_DROPPED_FRAMES) {
+            return (int)row.droppedFramesTheme;
+        }
+        break;
+    case Qt::ToolTipRole:
+        if (index.column() == COLUMN_STATUS && !row.statusToolTip.isEmpty()) {
+            return row.statusToolTip;
+        }
+        break;
     }
+
+    return QVariant();
 }
 
-void BranchOutputStatus::Update()
+bool OutputStatusModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    for (int i = 0; i < outputLabels.size(); i++) {
-        outputLabels[i].Update(false);
+    if (!index.isValid() || index.row() >= rows.size() || index.column() != COLUMN_FILTER ||
+        role != Qt::CheckStateRole) {
+        return false;
     }
+
+    auto &row = rows[index.row()];
+    row.enabled = value.toInt() == Qt::Checked;
+    obs_source_set_enabled(row.filter->source, row.enabled);
+
+    emit dataChanged(index, index, {Qt::CheckStateRole});
+    return true;
 }
 
-void BranchOutputStatus::showEvent(QShowEvent *)
+QVariant OutputStatusModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    timer.start(TIMER_INTERVAL);
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+    case COLUMN_FILTER:
+        return QTStr("FilterName");
+    case COLUMN_SOURCE:
+        return QTStr("SourceName");
+    case COLUMN_STATUS:
+        return QTStr("Status");
+    case COLUMN_DROPPED_FRAMES:
+        return QTStr("DropFrames");
+    case COLUMN_SENT_SIZE:
+        return QTStr("SentDataSize");
+    case COLUMN_BITRATE:
+        return QTStr("BitRate");
+    default:
+        return QString();
+    }
 }
 
-void BranchOutputStatus::hideEvent(QHideEvent *)
+Qt::ItemFlags OutputStatusModel::flags(const QModelIndex &index) const
 {
-    timer.stop();
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+
+    Qt::ItemFlags f = Qt::ItemIsEnabled;
+    if (index.column() == COLUMN_FILTER) {
+        f |= Qt::ItemIsUserCheckable;
+    }
+    return f;
 }
 
-void BranchOutputStatus::SetEabnleAll(bool enabled)
+void OutputStatusModel::AddFilter(filter_t *filter)
 {
-    for (int i = 0; i < outputLabels.size(); i++) {
-        obs_source_set_enabled(outputLabels[i].filter->source, enabled);
+    auto parent = obs_filter_get_parent(filter->source);
+    auto first = (int)rows.size();
+
+    // One row per destination and recording (Unused rows are hidden by the view)
+    beginInsertRows(QModelIndex(), first, first + MAX_STREAM_DESTINATIONS);
+    for (size_t i = 0; i <= MAX_STREAM_DESTINATIONS; i++) {
+        OutputRow row;
+        row.filter = filter;
+        row.index = i;
+        row.recording = i == MAX_STREAM_DESTINATIONS;
+        row.configured = i == 0;
+        row.enabled = obs_source_enabled(filter->source);
+        row.filterName = QString::fromUtf8(obs_source_get_name(filter->source));
+        row.parentName = QString::fromUtf8(obs_source_get_name(parent));
+        row.status = QTStr("Status.Inactive");
+        rows.push_back(row);
     }
+    endInsertRows();
 }
 
-// Imitate UI/window-basic-stats.cpp
-void setThemeID(QWidget *widget, const QString &themeID)
+void OutputStatusModel::RemoveFilter(filter_t *filter)
 {
-    if (widget->property("themeID").toString() != themeID) {
-        widget->setProperty("themeID", themeID);
-
-        /* force style sheet recalculation */
-        QString qss = widget->styleSheet();
-        widget->setStyleSheet("/* */");
-        widget->setStyleSheet(qss);
+    // Rows of the filter are contiguous
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < rows.size(); i++) {
+        if (rows[i].filter == filter) {
+            if (first < 0) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    if (first < 0) {
+        return;
     }
-}
 
-// BranchOutputStatus::OutputLabels structure
+    beginRemoveRows(QModelIndex(), first, last);
+    rows.erase(rows.begin() + first, rows.begin() + last + 1);
+    endRemoveRows();
+}
 
-// Imitate UI/window-basic-stats.cpp
-void BranchOutputStatus::OutputLabels::Update(bool rec)
+// Update rows in [first, last] from the telemetry snapshot and notify changed cells only.
+void OutputStatusModel::Refresh(int first, int last)
 {
-    auto output = filter->stream_output;
-    uint64_t totalBytes = output ? obs_output_get_total_bytes(output) : 0;
-    uint64_t curTime = os_gettime_ns();
-    uint64_t bytesSent = totalBytes;
-
-    if (bytesSent < lastBytesSent) {
-        bytesSent = 0;
+    if (first < 0) {
+        first = 0;
     }
-    if (bytesSent == 0) {
-        lastBytesSent = 0;
+    if (last >= rows.size()) {
+        last = (int)rows.size() - 1;
     }
 
-    uint64_t bitsBetween = (bytesSent - lastBytesSent) * 8;
-    long double timePassed = (long double)(curTime - lastBytesSentTime) / 1000000000.0l;
-    kbps = (long double)bitsBetween / timePassed / 1000.0l;
+    filter_t *lastFilter = nullptr;
+    telemetry_sample_t samples[2];
+    size_t count = 0;
 
-    if (timePassed < 0.01l) {
-        kbps = 0.0l;
-    }
+    for (int r = first; r <= last; r++) {
+        auto &row = rows[r];
 
-    QString str = QTStr("Status.Inactive");
-    QString themeID;
-    bool active = output ? obs_output_active(output) : false;
-    if (rec) {
-        if (active) {
-            str = QTStr("Status.Recording");
+        // Read the ring once per filter
+        if (row.filter != lastFilter) {
+            lastFilter = row.filter;
+            count = telemetry_ring_read(&row.filter->telemetry, samples, 2);
+        }
+
+        auto latest = count ? &samples[count - 1] : nullptr;
+        auto prev = count > 1 ? &samples[0] : nullptr;
+
+        telemetry_destination_t dest = {};
+        if (latest) {
+            dest = row.Destination(*latest);
+        }
+
+        int changedFirst = COLUMN_COUNT;
+        int changedLast = -1;
+        auto changed = [&](int column) {
+            changedFirst = std::min(changedFirst, column);
+            changedLast = std::max(changedLast, column);
+        };
+
+        // Filter name, enabled state and parent name (Cheap getters, no signal handlers needed)
+        if (update_value(row.filterName, QString::fromUtf8(obs_source_get_name(row.filter->source))) |
+            update_value(row.enabled, obs_source_enabled(row.filter->source))) {
+            changed(COLUMN_FILTER);
+        }
+        auto parent = obs_filter_get_parent(row.filter->source);
+        if (parent && update_value(row.parentName, QString::fromUtf8(obs_source_get_name(parent)))) {
+            changed(COLUMN_SOURCE);
         }
-    } else {
-        if (active) {
-            bool reconnecting = output ? obs_output_reconnecting(output) : false;
 
-            if (reconnecting) {
-                str = QTStr("Status.Reconnecting");
-                themeID = "error";
+        row.configured = (row.index == 0 && !row.recording) || dest.configured;
+
+        // Status
+        QString status = QTStr("Status.Inactive");
+        Theme statusTheme = THEME_NONE;
+        if (dest.active && row.recording) {
+            status = QTStr("Status.Recording");
+            statusTheme = THEME_GOOD;
+        } else if (dest.active) {
+            if (dest.reconnecting) {
+                status = QTStr("Status.Reconnecting");
+                statusTheme = THEME_ERROR;
             } else {
-                str = QTStr("Status.Live");
-                themeID = "good";
+                status = QTStr("Status.Live");
+                statusTheme = THEME_GOOD;
+            }
+        }
+
+        // Primary row shows filter-wide audio and encoder statistics
+        QString toolTip;
+        if (latest && row.index == 0 && !row.recording) {
+            toolTip = QTStr("Telemetry.Tooltip")
+                          .arg(QString::number(latest->audio_buffer_depth))
+                          .arg(QString::number(latest->audio_overruns))
+                          .arg(QString::number(latest->audio_underruns))
+                          .arg(QString::number(latest->video_frames_skipped))
+                          .arg(QString::number((double)latest->congestion * 100.0, 'f', 1));
+        }
+
+        if (update_value(row.status, status) | update_value(row.statusTheme, statusTheme) |
+            update_value(row.statusToolTip, toolTip)) {
+            changed(COLUMN_STATUS);
+        }
+
+        // Dropped frames
+        int total = dest.total_frames;
+        int dropped = dest.frames_dropped;
+        if (total < row.firstTotal || dropped < row.firstDropped) {
+            row.firstTotal = 0;
+            row.firstDropped = 0;
+        }
+        total -= row.firstTotal;
+        dropped -= row.firstDropped;
+
+        long double num = total ? (long double)dropped / (long double)total * 100.0l : 0.0l;
+        auto droppedFrames =
+            QString("%1 / %2 (%3%)")
+                .arg(QString::number(dropped), QString::number(total), QString::number((double)num, 'f', 1));
+        Theme droppedFramesTheme = num > 5.0l ? THEME_ERROR : num > 1.0l ? THEME_WARNING : THEME_NONE;
+
+        if (update_value(row.droppedFrames, droppedFrames) | update_value(row.droppedFramesTheme, droppedFramesTheme)) {
+            changed(COLUMN_DROPPED_FRAMES);
+        }
+
+        // Sent size
+        num = (long double)dest.bytes_sent / (1024.0l * 1024.0l);
+        const char *unit = "MiB";
+        if (num > 1024) {
+            num /= 1024;
+            unit = "GiB";
+        }
+        if (update_value(row.megabytesSent, QString("%1 %2").arg((double)num, 0, 'f', 1).arg(unit))) {
+            changed(COLUMN_SENT_SIZE);
+        }
+
+        // Bitrate from the last two samples
+        long double kbps = 0.0l;
+        if (prev && latest->timestamp > prev->timestamp) {
+            auto &prevDest = row.Destination(*prev);
+            if (prevDest.configured && dest.bytes_sent >= prevDest.bytes_sent) {
+                long double timePassed = (long double)(latest->timestamp - prev->timestamp) / 1000000000.0l;
+                if (timePassed >= 0.01l) {
+                    kbps = (long double)((dest.bytes_sent - prevDest.bytes_sent) * 8) / timePassed / 1000.0l;
+                }
             }
         }
+        num = kbps;
+        unit = "kb/s";
+        if (num >= 10'000) {
+            num /= 1000;
+            unit = "Mb/s";
+        }
+        if (update_value(row.bitrate, QString("%1 %2").arg((double)num, 0, 'f', 0).arg(unit))) {
+            changed(COLUMN_BITRATE);
+        }
+
+        if (changedLast >= 0) {
+            emit dataChanged(index(r, changedFirst), index(r, changedLast));
+        }
     }
+}
 
-    status->setText(str);
-    setThemeID(status, themeID);
+void OutputStatusModel::Reset(int r)
+{
+    if (r < 0 || r >= rows.size()) {
+        return;
+    }
 
-    long double num = (long double)totalBytes / (1024.0l * 1024.0l);
-    const char *unit = "MiB";
-    if (num > 1024) {
-        num /= 1024;
-        unit = "GiB";
+    auto &row = rows[r];
+    telemetry_sample_t sample;
+    if (!telemetry_ring_read(&row.filter->telemetry, &sample, 1) || !row.Destination(sample).configured) {
+        return;
     }
-    megabytesSent->setText(QString("%1 %2").arg((double)num, 0, 'f', 1).arg(unit));
 
-    num = kbps;
-    unit = "kb/s";
-    if (num >= 10'000) {
-        num /= 1000;
-        unit = "Mb/s";
+    row.firstTotal = row.Destination(sample).total_frames;
+    row.firstDropped = row.Destination(sample).frames_dropped;
+    Refresh(r, r);
+}
+
+void OutputStatusModel::SetEnableAll(bool enabled)
+{
+    filter_t *lastFilter = nullptr;
+    for (auto &row : rows) {
+        if (row.filter != lastFilter) {
+            lastFilter = row.filter;
+            obs_source_set_enabled(row.filter->source, enabled);
+        }
     }
-    bitrate->setText(QString("%1 %2").arg((double)num, 0, 'f', 0).arg(unit));
+}
 
-    if (!rec) {
-        int total = output ? obs_output_get_total_frames(output) : 0;
-        int dropped = output ? obs_output_get_frames_dropped(output) : 0;
+bool OutputStatusModel::IsRowConfigured(int r) const
+{
+    return r >= 0 && r < rows.size() && rows[r].configured;
+}
 
-        if (total < first_total || dropped < first_dropped) {
-            first_total = 0;
-            first_dropped = 0;
+// Only configured flag of every row (Hidden rows must be known before they become visible)
+void OutputStatusModel::RefreshConfigured()
+{
+    filter_t *lastFilter = nullptr;
+    telemetry_sample_t sample;
+    size_t count = 0;
+
+    for (auto &row : rows) {
+        if (row.filter != lastFilter) {
+            lastFilter = row.filter;
+            count = telemetry_ring_read(&row.filter->telemetry, &sample, 1);
         }
+        row.configured = (row.index == 0 && !row.recording) || (count && row.Destination(sample).configured);
+    }
+}
 
-        total -= first_total;
-        dropped -= first_dropped;
+// OutputStatusModel::OutputRow structure
 
-        num = total ? (long double)dropped / (long double)total * 100.0l : 0.0l;
+const telemetry_destination_t &OutputStatusModel::OutputRow::Destination(const telemetry_sample_t &sample) const
+{
+    return recording ? sample.recording : sample.destinations[index];
+}
 
-        str = QString("%1 / %2 (%3%)")
-                  .arg(QString::number(dropped), QString::number(total), QString::number((double)num, 'f', 1));
-        droppedFrames->setText(str);
+// ResetButtonDelegate class
 
-        if (num > 5.0l) {
-            setThemeID(droppedFrames, "error");
-        } else if (num > 1.0l) {
-            setThemeID(droppedFrames, "warning");
-        } else {
-            setThemeID(droppedFrames, "");
-        }
-    }
+void ResetButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionButton button;
+    button.rect = option.rect.adjusted(2, 2, -2, -2);
+    button.text = index.data(Qt::DisplayRole).toString();
+    button.state = QStyle::State_Enabled | QStyle::State_Raised;
 
-    lastBytesSent = bytesSent;
-    lastBytesSentTime = curTime;
+    auto style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
 }
 
-void BranchOutputStatus::OutputLabels::Reset()
+// ThemeColorDelegate class
+
+ThemeColorDelegate::ThemeColorDelegate(QWidget *parent) : QStyledItemDelegate(parent)
 {
-    auto output = filter->stream_output;
-    if (!output) {
-        return;
+    // Same themeIDs as UI/window-basic-stats.cpp
+    static const char *themeIDs[OutputStatusModel::THEME_COUNT] = {nullptr, "good", "warning", "error"};
+
+    for (int theme = OutputStatusModel::THEME_GOOD; theme < OutputStatusModel::THEME_COUNT; theme++) {
+        probes[theme] = new QLabel(parent);
+        probes[theme]->setProperty("themeID", themeIDs[theme]);
+        probes[theme]->hide();
+        probes[theme]->ensurePolished();
     }
+}
 
-    first_total = obs_output_get_total_frames(output);
-    first_dropped = obs_output_get_frames_dropped(output);
-    droppedFrames->setText(QString("0 / 0 (0)"));
-    megabytesSent->setText(QString("0 MiB"));
-    bitrate->setText(QString("0 kb/s"));
+void ThemeColorDelegate::initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const
+{
+    QStyledItemDelegate::initStyleOption(option, index);
+
+    auto theme = index.data(OutputStatusModel::ThemeRole).toInt();
+    if (theme > OutputStatusModel::THEME_NONE && theme < OutputStatusModel::THEME_COUNT) {
+        // Stylesheet's "color" is polished into label's foreground
+        option->palette.setColor(QPalette::Text, probes[theme]->palette().color(QPalette::WindowText));
+    }
 }
 
-// FilterCell class
+// BranchOutputStatus class
 
-FilterCell::FilterCell(QString text, obs_source_t *source, QWidget *parent) : QWidget(parent)
+BranchOutputStatus::BranchOutputStatus(QWidget *parent) : QFrame(parent), timer(this)
 {
-    setMinimumHeight(27);
+    setMinimumWidth(320);
+
+    model = new OutputStatusModel(this);
 
-    visibilityCheckbox = new QCheckBox(this);
-    visibilityCheckbox->setProperty("visibilityCheckBox", true);
-    visibilityCheckbox->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
-    visibilityCheckbox->setChecked(obs_source_enabled(source));
+    // Setup statistics table
+    outputTable = new QTableView(this);
+    outputTable->setModel(model);
+    outputTable->setItemDelegateForColumn(OutputStatusModel::COLUMN_RESET, new ResetButtonDelegate(this));
+    auto themeColorDelegate = new ThemeColorDelegate(this);
+    outputTable->setItemDelegateForColumn(OutputStatusModel::COLUMN_STATUS, themeColorDelegate);
+    outputTable->setItemDelegateForColumn(OutputStatusModel::COLUMN_DROPPED_FRAMES, themeColorDelegate);
+    outputTable->verticalHeader()->hide();
+    outputTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    outputTable->verticalHeader()->setDefaultSectionSize(32);
+    outputTable->horizontalHeader()->setSectionsClickable(false);
+    outputTable->horizontalHeader()->setMinimumSectionSize(100);
+    outputTable->setGridStyle(Qt::NoPen);
+    outputTable->setHorizontalScrollMode(QTableView::ScrollMode::ScrollPerPixel);
+    outputTable->setVerticalScrollMode(QTableView::ScrollMode::ScrollPerPixel);
+    outputTable->setSelectionMode(QTableView::SelectionMode::NoSelection);
+    outputTable->setFocusPolicy(Qt::FocusPolicy::NoFocus);
+    outputTable->setEditTriggers(QTableView::NoEditTriggers);
 
-    connect(visibilityCheckbox, &QCheckBox::clicked, [source](bool visible) {
-        obs_source_set_enabled(source, visible);
+    connect(outputTable, &QTableView::clicked, [this](const QModelIndex &index) {
+        if (index.column() == OutputStatusModel::COLUMN_RESET) {
+            model->Reset(index.row());
+        }
     });
 
-    name = new QLabel(text, this);
+    // Rows scrolled into view must be up to date
+    connect(outputTable->verticalScrollBar(), &QScrollBar::valueChanged, [this](int) { RefreshVisibleRows(); });
+
+    QObject::connect(&timer, &QTimer::timeout, this, &BranchOutputStatus::Update);
 
-    auto checkboxLayout = new QHBoxLayout();
-    checkboxLayout->setContentsMargins(0, 0, 0, 0);
-    checkboxLayout->addWidget(visibilityCheckbox);
-    checkboxLayout->addWidget(name);
-    setLayout(checkboxLayout);
+    timer.setInterval(TIMER_INTERVAL);
+    if (isVisible()) {
+        timer.start();
+    }
 
-    // Listen signal for filter update
-    filterRenamedSignal.Connect(obs_source_get_signal_handler(source), "rename", FilterCell::FilterRenamed, this);
+    // Tool buttons
+    auto enableAllButton = new QPushButton(QTStr("EnableAll"));
+    connect(enableAllButton, &QPushButton::clicked, [this]() { SetEabnleAll(true); });
 
-    // Listen signal for filter enabled/disabled
-    enableSignal.Connect(obs_source_get_signal_handler(source), "enable", FilterCell::VisibilityChanged, this);
+    auto disableAllButton = new QPushButton(QTStr("DisableAll"));
+    connect(disableAllButton, &QPushButton::clicked, [this]() { SetEabnleAll(false); });
+
+    auto buttonsContainerLayout = new QHBoxLayout();
+    buttonsContainerLayout->addWidget(enableAllButton);
+    buttonsContainerLayout->addWidget(disableAllButton);
+    buttonsContainerLayout->addStretch();
+
+    QVBoxLayout *outputContainerLayout = new QVBoxLayout();
+    outputContainerLayout->addWidget(outputTable);
+    outputContainerLayout->addLayout(buttonsContainerLayout);
+    this->setLayout(outputContainerLayout);
 }
 
-FilterCell::~FilterCell()
+BranchOutputStatus::~BranchOutputStatus() {}
+
+void BranchOutputStatus::AddFilter(filter_t *filter)
 {
-    filterRenamedSignal.Disconnect();
-    enableSignal.Disconnect();
+    auto first = model->rowCount();
+    model->AddFilter(filter);
+
+    for (int r = first; r < model->rowCount(); r++) {
+        outputTable->setRowHidden(r, !model->IsRowConfigured(r));
+    }
+    RefreshVisibleRows();
 }
 
-void FilterCell::SetText(QString text)
+void BranchOutputStatus::RemoveFilter(filter_t *filter)
 {
-    name->setText(text);
+    model->RemoveFilter(filter);
 }
 
-void FilterCell::FilterRenamed(void *data, calldata_t *cd)
+void BranchOutputStatus::Update()
 {
-    auto item = (FilterCell *)data;
-    auto newName = calldata_string(cd, "new_name");
-    item->SetText(QString::fromUtf8(newName));
+    // Hidden state for all rows, but contents for visible rows only.
+    model->RefreshConfigured();
+    for (int r = 0; r < model->rowCount(); r++) {
+        auto hidden = !model->IsRowConfigured(r);
+        if (outputTable->isRowHidden(r) != hidden) {
+            outputTable->setRowHidden(r, hidden);
+        }
+    }
+
+    RefreshVisibleRows();
 }
 
-void FilterCell::VisibilityChanged(void *data, calldata_t *cd)
+void BranchOutputStatus::RefreshVisibleRows()
 {
-    auto item = (FilterCell *)data;
-    auto enabled = calldata_bool(cd, "enabled");
-    item->visibilityCheckbox->setChecked(enabled);
-}
+    if (!model->rowCount()) {
+        return;
+    }
+
+    auto first = outputTable->rowAt(0);
+    auto last = outputTable->rowAt(outputTable->viewport()->height() - 1);
+    if (first < 0) {
+        return;
+    }
+    if (last < 0) {
+        // Viewport is taller than contents
+        last = model->rowCount() - 1;
+    }
 
-// ParentCell class
+    model->Refresh(first, last);
+}
 
-ParentCell::ParentCell(QString text, obs_source_t *source, QWidget *parent) : QLabel(text, parent)
+void BranchOutputStatus::showEvent(QShowEvent *)
 {
-    parentRenamedSignal.Connect(obs_source_get_signal_handler(source), "rename", ParentCell::ParentRenamed, this);
+    RefreshVisibleRows();
+    timer.start(TIMER_INTERVAL);
 }
 
-ParentCell::~ParentCell()
+void BranchOutputStatus::hideEvent(QHideEvent *)
 {
-    parentRenamedSignal.Disconnect();
+    timer.stop();
 }
 
-void ParentCell::ParentRenamed(void *data, calldata_t *cd)
+void BranchOutputStatus::SetEabnleAll(bool enabled)
 {
-    auto item = (ParentCell *)data;
-    auto newName = calldata_string(cd, "new_name");
-    item->setText(QString::fromUtf8(newName));
+    model->SetEnableAll(enabled);
 }
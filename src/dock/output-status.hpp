@@ -19,79 +19,125 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <obs-module.h>
-#include <obs.hpp>
 #include <QFrame>
-#include <QPointer>
 #include <QList>
 #include <QTimer>
-#include <QTableWidgetItem>
-#include <QLabel>
+#include <QString>
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
 
-class QTableWidget;
-class QString;
-class QCheckBox;
+class QTableView;
+class QLabel;
 struct filter_t;
+struct telemetry_sample_t;
+struct telemetry_destination_t;
 
-class FilterCell : public QWidget {
+// Rows: One per (filter, destination) and one for filter's recording. Values come from filter's telemetry snapshot,
+// so the dock never calls output APIs on UI thread.
+class OutputStatusModel : public QAbstractTableModel {
     Q_OBJECT
 
-    QCheckBox *visibilityCheckbox;
-    QLabel *name;
+public:
+    enum Column {
+        COLUMN_FILTER,
+        COLUMN_SOURCE,
+        COLUMN_STATUS,
+        COLUMN_DROPPED_FRAMES,
+        COLUMN_SENT_SIZE,
+        COLUMN_BITRATE,
+        COLUMN_RESET,
+        COLUMN_COUNT,
+    };
+
+    enum Theme {
+        THEME_NONE,
+        THEME_GOOD,
+        THEME_WARNING,
+        THEME_ERROR,
+        THEME_COUNT,
+    };
+
+    // Theme of status and dropped frames cells (Colored by ThemeColorDelegate)
+    static constexpr int ThemeRole = Qt::UserRole;
 
-    OBSSignal enableSignal;
-    OBSSignal filterRenamedSignal;
+private:
+    struct OutputRow {
+        filter_t *filter;
+        size_t index;           // Destination index
+        bool recording = false; // Recording row (Index is unused)
+        bool configured = false;
+        bool enabled = false;
+
+        QString filterName;
+        QString parentName;
+        QString status;
+        QString statusToolTip;
+        QString droppedFrames;
+        QString megabytesSent;
+        QString bitrate;
+        Theme statusTheme = THEME_NONE;
+        Theme droppedFramesTheme = THEME_NONE;
+
+        int firstTotal = 0;
+        int firstDropped = 0;
+
+        const telemetry_destination_t &Destination(const telemetry_sample_t &sample) const;
+    };
+
+    QList<OutputRow> rows;
 
 public:
-    FilterCell(QString text, obs_source_t *_source, QWidget *parent = (QWidget *)nullptr);
-    ~FilterCell();
+    explicit OutputStatusModel(QObject *parent = nullptr);
 
-    void SetText(QString text);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
 
-    static void VisibilityChanged(void *data, calldata_t *cd);
-    static void FilterRenamed(void *data, calldata_t *cd);
+    void AddFilter(filter_t *filter);
+    void RemoveFilter(filter_t *filter);
+    void Refresh(int first, int last);
+    void Reset(int row);
+    void SetEnableAll(bool enabled);
+    bool IsRowConfigured(int row) const;
+    void RefreshConfigured();
 };
 
-class ParentCell : public QLabel {
+// Draws "Reset" button into the cell (Click is handled by the view)
+class ResetButtonDelegate : public QStyledItemDelegate {
     Q_OBJECT
 
-    OBSSignal parentRenamedSignal;
-
 public:
-    ParentCell(QString text, obs_source_t *source, QWidget *parent = (QWidget *)nullptr);
-    ~ParentCell();
+    explicit ResetButtonDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {}
 
-    static void ParentRenamed(void *data, calldata_t *cd);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 };
 
-class BranchOutputStatus : public QFrame {
+// Colors cell text by its theme like OBS's stats window: Hidden labels with "themeID" property take colors
+// from the active stylesheet, so theme changes apply as well.
+class ThemeColorDelegate : public QStyledItemDelegate {
     Q_OBJECT
 
-    struct OutputLabels {
-        filter_t *filter;
-        FilterCell *filterCell;
-        ParentCell *parentCell;
-        QLabel *status;
-        QLabel *droppedFrames;
-        QLabel *megabytesSent;
-        QLabel *bitrate;
+    QLabel *probes[OutputStatusModel::THEME_COUNT] = {};
 
-        uint64_t lastBytesSent = 0;
-        uint64_t lastBytesSentTime = 0;
-
-        int first_total = 0;
-        int first_dropped = 0;
+public:
+    explicit ThemeColorDelegate(QWidget *parent);
 
-        void Update(bool rec);
-        void Reset();
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override;
+};
 
-        long double kbps = 0.0l;
-    };
+class BranchOutputStatus : public QFrame {
+    Q_OBJECT
 
     QTimer timer;
-    QTableWidget *outputTable = nullptr;
-    QList<OutputLabels> outputLabels;
+    QTableView *outputTable = nullptr;
+    OutputStatusModel *model = nullptr;
 
     void Update();
+    void RefreshVisibleRows();
 
 public:
     BranchOutputStatus(QWidget *parent = (QWidget *)nullptr);
@@ -0,0 +1,154 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <string>
+#include <vector>
+#include "encoder-pool.hpp"
+
+struct encoder_device_t {
+    std::string encoder_id;
+    int gpu; // -1: Encoder has no device selection
+    bool hardware;
+    uint32_t capacity;
+    uint32_t sessions;   // Protected by pool mutex
+    uint64_t pixel_rate; // Total of placed encoders
+};
+
+struct encoder_placement_t {
+    encoder_device_t *device;
+    uint64_t pixel_rate;
+};
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<encoder_device_t *> devices;
+static encoder_device_t software_device = {ENCODER_POOL_SOFTWARE_ID, -1, false, ENCODER_POOL_DEFAULT_SOFTWARE_SESSIONS};
+
+void encoder_pool_add_device(const char *encoder_id, int gpu, uint32_t sessions)
+{
+    if (!sessions || !obs_get_encoder_codec(encoder_id)) {
+        obs_log(LOG_INFO, "Encoder pool: %s (GPU %d) is not available", encoder_id, gpu);
+        return;
+    }
+
+    auto device = new encoder_device_t();
+    device->encoder_id = encoder_id;
+    device->gpu = gpu;
+    device->hardware = true;
+    device->capacity = sessions;
+
+    pthread_mutex_lock(&pool_mutex);
+    devices.push_back(device);
+    pthread_mutex_unlock(&pool_mutex);
+
+    obs_log(LOG_INFO, "Encoder pool: %s (GPU %d) with %u sessions", encoder_id, gpu, sessions);
+}
+
+void encoder_pool_set_software_sessions(uint32_t sessions)
+{
+    pthread_mutex_lock(&pool_mutex);
+    software_device.capacity = sessions;
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+// NOTE: Must be called after every placement was released.
+void encoder_pool_clear()
+{
+    pthread_mutex_lock(&pool_mutex);
+    for (auto device : devices) {
+        delete device;
+    }
+    devices.clear();
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+// Load after placing (Lower is better)
+inline double device_load(const encoder_device_t *device, uint64_t pixel_rate)
+{
+    return (double)(device->pixel_rate + pixel_rate) / (double)device->capacity;
+}
+
+encoder_placement_t *encoder_pool_acquire(uint64_t pixel_rate, const char *name)
+{
+    pthread_mutex_lock(&pool_mutex);
+
+    encoder_device_t *selected = nullptr;
+    for (auto device : devices) {
+        if (device->sessions >= device->capacity) {
+            continue;
+        }
+        if (!selected || device_load(device, pixel_rate) < device_load(selected, pixel_rate)) {
+            selected = device;
+        }
+    }
+
+    if (!selected && software_device.sessions < software_device.capacity) {
+        obs_log(LOG_WARNING, "%s: No hardware encoder session is left, fallback to software encoder", name);
+        selected = &software_device;
+    }
+
+    if (!selected) {
+        pthread_mutex_unlock(&pool_mutex);
+        obs_log(LOG_ERROR, "%s: No encoder session is left", name);
+        return nullptr;
+    }
+
+    selected->sessions++;
+    selected->pixel_rate += pixel_rate;
+
+    obs_log(
+        LOG_INFO, "%s: Placed on %s (GPU %d), sessions %u/%u", name, selected->encoder_id.c_str(), selected->gpu,
+        selected->sessions, selected->capacity
+    );
+    pthread_mutex_unlock(&pool_mutex);
+
+    auto placement = new encoder_placement_t();
+    placement->device = selected;
+    placement->pixel_rate = pixel_rate;
+    return placement;
+}
+
+void encoder_pool_release(encoder_placement_t *placement)
+{
+    if (!placement) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    placement->device->sessions--;
+    placement->device->pixel_rate -= placement->pixel_rate;
+    pthread_mutex_unlock(&pool_mutex);
+
+    delete placement;
+}
+
+const char *encoder_placement_get_id(const encoder_placement_t *placement)
+{
+    return placement->device->encoder_id.c_str();
+}
+
+void encoder_placement_apply(const encoder_placement_t *placement, obs_data_t *encoder_settings)
+{
+    if (placement->device->gpu >= 0) {
+        obs_data_set_int(encoder_settings, "gpu", placement->device->gpu);
+    }
+    // Every H.264 encoder of obs-studio accepts these (Rate control chosen by user is kept)
+    obs_data_set_default_string(encoder_settings, "rate_control", "CBR");
+}
@@ -0,0 +1,45 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Pseudo encoder id which lets the pool place the encoder
+#define ENCODER_POOL_AUTO_ID "branch_output_auto_hardware"
+#define ENCODER_POOL_JSON_NAME "encoders.json"
+#define ENCODER_POOL_SOFTWARE_ID "obs_x264"
+#define ENCODER_POOL_DEFAULT_SOFTWARE_SESSIONS 2
+
+// Hardware encoder devices (Encoder id and GPU index) with session capacity.
+// acquire() places a new encoder on the device which has a free session and the lowest load
+// (Pixel rate per session capacity). Software encoder is used only when every device is full,
+// and its sessions are limited too, so CPU doesn't get saturated silently.
+struct encoder_placement_t;
+
+void encoder_pool_add_device(const char *encoder_id, int gpu, uint32_t sessions);
+void encoder_pool_set_software_sessions(uint32_t sessions);
+void encoder_pool_clear();
+
+// Returns NULL when no session is left
+encoder_placement_t *encoder_pool_acquire(uint64_t pixel_rate, const char *name);
+void encoder_pool_release(encoder_placement_t *placement);
+
+const char *encoder_placement_get_id(const encoder_placement_t *placement);
+// Set device selection and default rate control into encoder settings (Once at encoder creation)
+void encoder_placement_apply(const encoder_placement_t *placement, obs_data_t *encoder_settings);
@@ -18,7 +18,55 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <obs-module.h>
 #include <plugin-support.h>
+#include <util/platform.h>
 #include "plugin-main.hpp"
+#include "audio/audio-consumer.hpp"
+
+#ifdef BENCHMARK_AUDIO
+#include "audio/audio-bench.hpp"
+
+// Totals of all filters and groups
+static audio_bench_histogram_t bench_push;
+static audio_bench_histogram_t bench_lock_hold;
+static audio_bench_histogram_t bench_mix;
+static std::atomic<uint64_t> bench_report_at;
+static long bench_last_allocs;
+
+// Report totals periodically by one of the callers, and each group's soak state by itself.
+// Allocations are process-wide (bmem), so steady count means the audio path doesn't allocate.
+static void bench_report(encoder_group_t *group)
+{
+    auto now = os_gettime_ns();
+    auto report_at = bench_report_at.load(std::memory_order_relaxed);
+    if (now >= report_at && bench_report_at.compare_exchange_strong(report_at, now + AUDIO_BENCH_REPORT_INTERVAL_NS)) {
+        audio_bench_report("push_audio_to_buffer", &bench_push);
+        audio_bench_report("audio_input_callback (Lock hold)", &bench_lock_hold);
+        audio_bench_report("audio_input_callback (Mix)", &bench_mix);
+
+        auto allocs = bnum_allocs();
+        obs_log(LOG_INFO, "[bench] Allocations: %ld (%+ld)", allocs, allocs - bench_last_allocs);
+        bench_last_allocs = allocs;
+
+        auto arena = audio_arena_get_stats();
+        obs_log(
+            LOG_INFO, "[bench] Audio arena: allocated=%llu reused=%llu in_use=%llu pooled=%llu bytes=%llu",
+            (unsigned long long)arena.allocated, (unsigned long long)arena.reused, (unsigned long long)arena.in_use,
+            (unsigned long long)arena.pooled, (unsigned long long)arena.bytes
+        );
+    }
+
+    if (now >= group->bench_report_at) {
+        group->bench_report_at = now + AUDIO_BENCH_REPORT_INTERVAL_NS;
+        obs_log(
+            LOG_INFO, "[bench] %s: depth=%llu overruns=%llu underruns=%llu drift_dropped=%llu drift_repeated=%llu",
+            group->name.c_str(), (unsigned long long)group->audio_stats.buffer_depth.load(std::memory_order_relaxed),
+            (unsigned long long)group->audio_stats.overruns.load(std::memory_order_relaxed),
+            (unsigned long long)group->audio_stats.underruns.load(std::memory_order_relaxed),
+            (unsigned long long)group->audio_drift.dropped, (unsigned long long)group->audio_drift.repeated
+        );
+    }
+}
+#endif
 
 inline void push_audio_to_buffer(void *param, obs_audio_data *audio_data)
 {
@@ -28,55 +76,21 @@ inline void push_audio_to_buffer(void *param, obs_audio_data *audio_data)
     return;
 #endif
 
-    if (!filter->output_active || filter->audio_source_type == AUDIO_SOURCE_TYPE_SILENCE || !audio_data->frames) {
+    if (!audio_data->frames) {
         return;
     }
 
-    pthread_mutex_lock(&filter->audio_buffer_mutex);
-    {
-        if (filter->audio_buffer_frames + audio_data->frames > MAX_AUDIO_BUFFER_FRAMES) {
-            obs_log(LOG_WARNING, "%s: The audio buffer is full", obs_source_get_name(filter->source));
-            deque_free(&filter->audio_buffer);
-            deque_init(&filter->audio_buffer);
-            filter->audio_buffer_frames = 0;
-        }
-
-        // Compute header
-        audio_buffer_chunk_header_t header = {0};
-        header.frames = audio_data->frames;
-        header.timestamp = audio_data->timestamp;
-        for (int ch = 0; ch < filter->audio_channels; ch++) {
-            if (!audio_data->data[ch]) {
-                continue;
-            }
-            header.data_idx[ch] = sizeof(audio_buffer_chunk_header_t) + header.channels * audio_data->frames * 4;
-            header.channels++;
-        }
-
-        // Push audio data to buffer
-        deque_push_back(&filter->audio_buffer, &header, sizeof(audio_buffer_chunk_header_t));
-        for (int ch = 0; ch < filter->audio_channels; ch++) {
-            if (!audio_data->data[ch]) {
-                continue;
-            }
-            deque_push_back(&filter->audio_buffer, audio_data->data[ch], audio_data->frames * 4);
-        }
+#ifdef BENCHMARK_AUDIO
+    auto bench_start = os_gettime_ns();
+#endif
 
-        // Ensure allocation of audio_conv_buffer
-        size_t data_size = sizeof(audio_buffer_chunk_header_t) + header.channels * audio_data->frames * 4;
-        if (data_size > filter->audio_conv_buffer_size) {
-            obs_log(
-                LOG_INFO, "%s: Expand audio_conv_buffer from %zu to %zu bytes", obs_source_get_name(filter->source),
-                filter->audio_conv_buffer_size, data_size
-            );
-            filter->audio_conv_buffer = (uint8_t *)brealloc(filter->audio_conv_buffer, data_size);
-            filter->audio_conv_buffer_size = data_size;
-        }
+    // Push audio data to buffer (Never blocks)
+    audio_ring_write(&filter->audio_buffer, audio_data->data, audio_data->frames, audio_data->timestamp);
+    telemetry_count(filter->audio_stats.frames_pushed, audio_data->frames);
 
-        // Increment buffer usage
-        filter->audio_buffer_frames += audio_data->frames;
-    }
-    pthread_mutex_unlock(&filter->audio_buffer_mutex);
+#ifdef BENCHMARK_AUDIO
+    audio_bench_record(&bench_push, os_gettime_ns() - bench_start, audio_data->frames);
+#endif
 }
 
 // Callback from filter audio
@@ -84,8 +98,8 @@ obs_audio_data *audio_filter_callback(void *param, obs_audio_data *audio_data)
 {
     auto filter = (filter_t *)param;
 
-    if (filter->audio_source_type != AUDIO_SOURCE_TYPE_FILTER) {
-        // Omit filter's audio
+    if (filter->audio_source_type.load(std::memory_order_relaxed) != AUDIO_SOURCE_TYPE_FILTER) {
+        // Omit filter's audio (Or not joined to encoder group yet, buffer is always allocated so relaxed is enough)
         return audio_data;
     }
 
@@ -94,125 +108,220 @@ obs_audio_data *audio_filter_callback(void *param, obs_audio_data *audio_data)
     return audio_data;
 }
 
-inline void convert_audio_data(obs_audio_data *dest, const audio_data *src)
+// Mix group's buffered frames into active mixers (See audio_consumer_mix())
+static void mix_buffered_frames(
+    encoder_group_t *group, size_t pad, size_t frames, uint32_t mixers, audio_output_data *mixes
+)
 {
-    memcpy(dest->data, src->data, sizeof(audio_data::data));
-    dest->frames = src->frames;
-    dest->timestamp = src->timestamp;
+#ifdef BENCHMARK_AUDIO
+    auto bench_mix_start = os_gettime_ns();
+#endif
+
+    audio_consumer_mix(&group->audio_reader, group->audio_channels, pad, frames, mixers, mixes);
+
+#ifdef BENCHMARK_AUDIO
+    audio_bench_record(&bench_mix, os_gettime_ns() - bench_mix_start, AUDIO_OUTPUT_FRAMES);
+#endif
 }
 
-// Callback from source's audio capture
-void audio_capture_callback(void *param, obs_source_t *, const audio_data *audio_data, bool muted)
+// Callback from audio output
+bool audio_input_callback(
+    void *param, uint64_t start_ts_in, uint64_t, uint64_t *out_ts, uint32_t mixers, audio_output_data *mixes
+)
 {
-    auto filter = (filter_t *)param;
+    auto group = (encoder_group_t *)param;
+    *out_ts = start_ts_in;
 
-    if (muted || !filter->audio_source) {
-        return;
+    auto trace = latency_trace_sample(&group->latency_trace, LATENCY_STAGE_AUDIO_CALLBACK);
+    auto trace_start = trace ? os_gettime_ns() : 0;
+
+    obs_audio_info audio_info;
+    if (group->audio_source_type == AUDIO_SOURCE_TYPE_SILENCE || !obs_get_audio_info(&audio_info)) {
+        // Silence
+        return true;
     }
 
-    obs_audio_data filter_audio_data = {0};
-    convert_audio_data(&filter_audio_data, audio_data);
-    push_audio_to_buffer(filter, &filter_audio_data);
-}
+    // Reader is being re-attached to another ring -> Silence (DO NOT stall audio output pipeline)
+    if (pthread_mutex_trylock(&group->audio_reader_mutex) != 0) {
+        return true;
+    }
 
-// Callback from master audio output
-void master_audio_callback(void *param, size_t, audio_data *audio_data)
-{
-    auto filter = (filter_t *)param;
+#ifdef BENCHMARK_AUDIO
+    auto bench_lock_start = os_gettime_ns();
+#endif
+
+    auto reader = &group->audio_reader;
+
+    auto drift = &group->audio_drift;
 
-    obs_audio_data filter_audio_data = {0};
-    convert_audio_data(&filter_audio_data, audio_data);
-    push_audio_to_buffer(filter, &filter_audio_data);
+    auto pass = audio_consumer_prepare(reader, drift);
+    if (pass.skipped) {
+        obs_log(LOG_WARNING, "%s: The audio buffer is full, skip %zu frames", group->name.c_str(), pass.skipped);
+        telemetry_count(group->audio_stats.overruns);
+    }
+    group->audio_stats.buffer_depth.store(pass.depth, std::memory_order_relaxed);
+
+    auto consume = pass.consume;
+    if (!consume) {
+        // Wait until target latency is buffered.
+        if (pass.was_primed) {
+            obs_log(LOG_DEBUG, "%s: Wait for frames...", group->name.c_str());
+        }
+        telemetry_count(group->audio_stats.underruns);
+
+        auto output = true;
+        if (drift->started) {
+            // Silence continues the timeline
+            *out_ts = drift->next_ts;
+            drift->next_ts += audio_frames_to_ns(AUDIO_OUTPUT_FRAMES, group->samples_per_sec);
+        } else if (!drift->wait_since) {
+            drift->wait_since = start_ts_in;
+            output = false;
+        } else if (start_ts_in - drift->wait_since < AUDIO_START_TIMEOUT_NS) {
+            // Output nothing until first audio arrives, so that encoders start with aligned audio
+            output = false;
+        }
+        pthread_mutex_unlock(&group->audio_reader_mutex);
+
+#ifdef BENCHMARK_AUDIO
+        audio_bench_record(&bench_lock_hold, os_gettime_ns() - bench_lock_start, 0);
+        bench_report(group);
+#endif
+
+        // DO NOT stall audio output pipeline
+        return output;
+    }
+
+    // Place first output at the capture timestamp of its first frame (Aligned with video by libobs).
+    // Later outputs are contiguous because drift correction keeps the buffer around target latency.
+    uint64_t ts;
+    if (drift->started) {
+        *out_ts = drift->next_ts;
+    } else if (audio_ring_timestamp(reader, &ts)) {
+        *out_ts = ts;
+    }
+    drift->started = true;
+    drift->next_ts = *out_ts + audio_frames_to_ns(AUDIO_OUTPUT_FRAMES, group->samples_per_sec);
+
+    // Dropping one frame consumes it without mixing
+    mix_buffered_frames(group, 0, consume < AUDIO_OUTPUT_FRAMES ? consume : AUDIO_OUTPUT_FRAMES, mixers, mixes);
+
+    if (trace) {
+        // Capture timestamp of consumed frames
+        uint64_t capture_ts;
+        if (audio_ring_timestamp(reader, &capture_ts)) {
+            latency_trace_record(&group->latency_trace, LATENCY_STAGE_AUDIO_BUFFER, capture_ts, os_gettime_ns());
+        }
+    }
+
+    // Release consumed frames
+    audio_ring_advance(reader, consume);
+    telemetry_count(group->audio_stats.frames_popped, consume);
+
+    pthread_mutex_unlock(&group->audio_reader_mutex);
+
+#ifdef BENCHMARK_AUDIO
+    audio_bench_record(&bench_lock_hold, os_gettime_ns() - bench_lock_start, consume);
+    bench_report(group);
+#endif
+
+    if (trace) {
+        latency_trace_record(&group->latency_trace, LATENCY_STAGE_AUDIO_CALLBACK, trace_start, os_gettime_ns());
+    }
+    return true;
 }
 
-// Callback from audio output
-bool audio_input_callback(
+// Callback from shared audio bus (Fills the assigned track only)
+// The bus outputs every track at its window timestamp, so the read cursor follows the window by capture timestamps
+// (Skip stale frames or pad silence) instead of placing output at them. Reports timestamp of the output's first frame.
+bool audio_bus_track_callback(
     void *param, uint64_t start_ts_in, uint64_t, uint64_t *out_ts, uint32_t mixers, audio_output_data *mixes
 )
 {
-    auto filter = (filter_t *)param;
+    auto group = (encoder_group_t *)param;
+    *out_ts = start_ts_in;
 
     obs_audio_info audio_info;
-    if (!filter->output_active || filter->audio_source_type == AUDIO_SOURCE_TYPE_SILENCE ||
-        !obs_get_audio_info(&audio_info)) {
+    if (group->audio_source_type == AUDIO_SOURCE_TYPE_SILENCE || !obs_get_audio_info(&audio_info)) {
         // Silence
-        *out_ts = start_ts_in;
         return true;
     }
 
-    // TODO: Shorten the critical section to reduce audio delay
-    pthread_mutex_lock(&filter->audio_buffer_mutex);
-    {
-        if (filter->audio_buffer_frames < AUDIO_OUTPUT_FRAMES) {
-            // Wait until enough frames are receved.
-            if (!filter->audio_skip) {
-                obs_log(LOG_DEBUG, "%s: Wait for frames...", obs_source_get_name(filter->source));
-            }
-            filter->audio_skip++;
-            pthread_mutex_unlock(&filter->audio_buffer_mutex);
-
-            // DO NOT stall audio output pipeline
-            *out_ts = start_ts_in;
-            return true;
+    // Reader is being re-attached to another ring -> Silence (DO NOT stall audio bus)
+    if (pthread_mutex_trylock(&group->audio_reader_mutex) != 0) {
+        return true;
+    }
+
+    auto reader = &group->audio_reader;
+    auto drift = &group->audio_drift;
+
+    auto buffer_frames = audio_ring_readable(reader);
+    if (audio_ring_overrun(reader, buffer_frames)) {
+        // Producer ran ahead -> Skip to target latency (Alignment below corrects the rest)
+        obs_log(
+            LOG_WARNING, "%s: The audio buffer is full, skip %zu frames", group->name.c_str(),
+            buffer_frames - AUDIO_TARGET_LATENCY_FRAMES
+        );
+        audio_ring_advance(reader, buffer_frames - AUDIO_TARGET_LATENCY_FRAMES);
+        buffer_frames = AUDIO_TARGET_LATENCY_FRAMES;
+        telemetry_count(group->audio_stats.overruns);
+    }
+    group->audio_stats.buffer_depth.store(buffer_frames, std::memory_order_relaxed);
+
+    uint64_t ts;
+    if (!buffer_frames || !audio_ring_timestamp(reader, &ts)) {
+        // Nothing captured yet
+        telemetry_count(group->audio_stats.underruns);
+        pthread_mutex_unlock(&group->audio_reader_mutex);
+        return true;
+    }
+
+    // Positive error: Read cursor is behind the window
+    auto error = (int64_t)(start_ts_in - ts);
+    auto error_frames = audio_ns_to_frames((uint64_t)(error < 0 ? -error : error), group->samples_per_sec);
+    size_t pad = 0;
+    size_t consume = AUDIO_OUTPUT_FRAMES;
+
+    if (error_frames > AUDIO_ALIGN_TOLERANCE_FRAMES) {
+        if (error > 0) {
+            // Window has passed these frames
+            auto skip = error_frames < buffer_frames ? error_frames : buffer_frames;
+            obs_log(LOG_DEBUG, "%s: Discard %zu stale frames", group->name.c_str(), skip);
+            audio_ring_advance(reader, skip);
+            buffer_frames -= skip;
+            ts += audio_frames_to_ns((uint64_t)skip, group->samples_per_sec);
         } else {
-            filter->audio_skip = 0;
+            // Window is before buffered frames
+            pad = error_frames < AUDIO_OUTPUT_FRAMES ? error_frames : AUDIO_OUTPUT_FRAMES;
+            consume -= pad;
         }
-
-        size_t max_frames = AUDIO_OUTPUT_FRAMES;
-
-        while (max_frames > 0 && filter->audio_buffer_frames) {
-            // Peek header of first chunk
-            deque_peek_front(&filter->audio_buffer, filter->audio_conv_buffer, sizeof(audio_buffer_chunk_header_t));
-            auto header = (audio_buffer_chunk_header_t *)filter->audio_conv_buffer;
-            size_t data_size = sizeof(audio_buffer_chunk_header_t) + header->channels * header->frames * 4;
-
-            // Read chunk data
-            deque_peek_front(&filter->audio_buffer, filter->audio_conv_buffer, data_size);
-
-            size_t chunk_frames = header->frames - header->offset;
-            size_t frames = (chunk_frames > max_frames) ? max_frames : chunk_frames;
-            size_t out_offset = AUDIO_OUTPUT_FRAMES - max_frames;
-
-            for (size_t mix_idx = 0; mix_idx < MAX_AUDIO_MIXES; mix_idx++) {
-                if ((mixers & (1 << mix_idx)) == 0) {
-                    continue;
-                }
-                for (size_t ch = 0; ch < filter->audio_channels; ch++) {
-                    auto out = mixes[mix_idx].data[ch] + out_offset;
-                    if (!header->data_idx[ch]) {
-                        continue;
-                    }
-                    auto in = (float *)(filter->audio_conv_buffer + header->data_idx[ch]) + header->offset;
-
-                    for (size_t i = 0; i < frames; i++) {
-                        *out += *(in++);
-                        if (*out > 1.0f) {
-                            *out = 1.0f;
-                        } else if (*out < -1.0f) {
-                            *out = -1.0f;
-                        }
-                        out++;
-                    }
-                }
-            }
-
-            if (frames == chunk_frames) {
-                // Remove fulfilled chunk from buffer
-                deque_pop_front(&filter->audio_buffer, NULL, data_size);
-            } else {
-                // Chunk frames are remaining -> modify chunk header
-                header->offset += frames;
-                deque_place(&filter->audio_buffer, 0, header, sizeof(audio_buffer_chunk_header_t));
-            }
-
-            max_frames -= frames;
-
-            // Decrement buffer usage
-            filter->audio_buffer_frames -= frames;
+    } else if (error_frames > AUDIO_ALIGN_JITTER_FRAMES) {
+        // Slight drift -> Drop or repeat one frame (Inaudible)
+        if (error > 0) {
+            consume++;
+            drift->dropped++;
+        } else {
+            consume--;
+            drift->repeated++;
         }
     }
-    pthread_mutex_unlock(&filter->audio_buffer_mutex);
 
-    *out_ts = start_ts_in;
+    if (buffer_frames < consume) {
+        // Window's frames haven't arrived yet
+        telemetry_count(group->audio_stats.underruns);
+        pthread_mutex_unlock(&group->audio_reader_mutex);
+        return true;
+    }
+
+    *out_ts = ts - audio_frames_to_ns((uint64_t)pad, group->samples_per_sec);
+    if (consume) {
+        mix_buffered_frames(group, pad, consume < AUDIO_OUTPUT_FRAMES ? consume : AUDIO_OUTPUT_FRAMES, mixers, mixes);
+    }
+
+    // Release consumed frames
+    audio_ring_advance(reader, consume);
+    telemetry_count(group->audio_stats.frames_popped, consume);
+
+    pthread_mutex_unlock(&group->audio_reader_mutex);
     return true;
 }
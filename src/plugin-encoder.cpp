@@ -0,0 +1,810 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <map>
+#include "plugin-main.hpp"
+#include "encoder/encoder-pool.hpp"
+#include "video/frame-divider.hpp"
+
+// Shared groups only (Private groups aren't registered)
+static pthread_mutex_t groups_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string, encoder_group_t *> encoder_groups;
+
+// Filter settings which shape the group (Except video encoder's own settings)
+static const char *group_settings[] = {
+    "video_encoder", "audio_encoder", "audio_bitrate", "custom_audio_source", "audio_bus", "output_height",
+    "scale_type", "frame_rate_divisor", "resolution_lock", "output_format", "output_colorspace", "output_range",
+};
+
+inline void append_item_value(std::string &str, obs_data_item_t *item)
+{
+    switch (obs_data_item_gettype(item)) {
+    case OBS_DATA_STRING:
+        str += obs_data_item_get_string(item);
+        break;
+    case OBS_DATA_NUMBER:
+        if (obs_data_item_numtype(item) == OBS_DATA_NUM_DOUBLE) {
+            str += std::to_string(obs_data_item_get_double(item));
+        } else {
+            str += std::to_string(obs_data_item_get_int(item));
+        }
+        break;
+    case OBS_DATA_BOOLEAN:
+        str += obs_data_item_get_bool(item) ? "true" : "false";
+        break;
+    case OBS_DATA_OBJECT: {
+        auto obj = obs_data_item_get_obj(item);
+        if (obj) {
+            str += obs_data_get_json_with_defaults(obj);
+            obs_data_release(obj);
+        }
+        break;
+    }
+    case OBS_DATA_ARRAY: {
+        auto array = obs_data_item_get_array(item);
+        for (size_t i = 0; i < obs_data_array_count(array); i++) {
+            auto element = obs_data_array_item(array, i);
+            str += obs_data_get_json_with_defaults(element);
+            obs_data_release(element);
+        }
+        obs_data_array_release(array);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Append "name=value;" with user value or default, so explicit and default values make the same string.
+inline void append_setting(std::string &str, obs_data_t *data, const char *name)
+{
+    str += name;
+    str += "=";
+    auto item = obs_data_item_byname(data, name);
+    if (item) {
+        append_item_value(str, item);
+        obs_data_item_release(&item);
+    }
+    str += ";";
+}
+
+inline void copy_user_value(obs_data_t *dest, obs_data_item_t *item)
+{
+    auto name = obs_data_item_get_name(item);
+
+    switch (obs_data_item_gettype(item)) {
+    case OBS_DATA_STRING:
+        obs_data_set_string(dest, name, obs_data_item_get_string(item));
+        break;
+    case OBS_DATA_NUMBER:
+        if (obs_data_item_numtype(item) == OBS_DATA_NUM_DOUBLE) {
+            obs_data_set_double(dest, name, obs_data_item_get_double(item));
+        } else {
+            obs_data_set_int(dest, name, obs_data_item_get_int(item));
+        }
+        break;
+    case OBS_DATA_BOOLEAN:
+        obs_data_set_bool(dest, name, obs_data_item_get_bool(item));
+        break;
+    case OBS_DATA_OBJECT: {
+        auto obj = obs_data_item_get_obj(item);
+        obs_data_set_obj(dest, name, obj);
+        obs_data_release(obj);
+        break;
+    }
+    case OBS_DATA_ARRAY: {
+        auto array = obs_data_item_get_array(item);
+        obs_data_set_array(dest, name, array);
+        obs_data_array_release(array);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+inline std::vector<std::string> get_setting_names(obs_data_t *data)
+{
+    std::vector<std::string> names;
+    for (auto item = obs_data_first(data); item; obs_data_item_next(&item)) {
+        names.push_back(obs_data_item_get_name(item));
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// "Auto" accepts only settings which every encoder accepts (Same as its properties)
+inline obs_data_t *create_video_encoder_defaults(const char *encoder_id)
+{
+    if (!strcmp(encoder_id, ENCODER_POOL_AUTO_ID)) {
+        auto defaults = obs_data_create();
+        obs_data_set_default_int(defaults, "bitrate", 6000);
+        obs_data_set_default_int(defaults, "keyint_sec", 2);
+        return defaults;
+    }
+
+    auto defaults = obs_encoder_defaults(encoder_id);
+    return defaults ? defaults : obs_data_create();
+}
+
+// Video encoder's own settings picked from filter settings (Encoder defaults for the unset ones)
+obs_data_t *create_video_encoder_settings(obs_data_t *settings)
+{
+    auto encoder_settings = create_video_encoder_defaults(obs_data_get_string(settings, "video_encoder"));
+
+    for (auto &name : get_setting_names(encoder_settings)) {
+        auto item = obs_data_item_byname(settings, name.c_str());
+        if (item && obs_data_item_has_user_value(item)) {
+            copy_user_value(encoder_settings, item);
+        }
+        obs_data_item_release(&item);
+    }
+
+    return encoder_settings;
+}
+
+// Encoder-relevant settings in a canonical form (Independent of key order and explicit/default values)
+std::string normalize_encoder_settings(obs_data_t *settings)
+{
+    std::string str;
+    for (auto name : group_settings) {
+        append_setting(str, settings, name);
+    }
+    if (obs_data_get_bool(settings, "custom_audio_source")) {
+        append_setting(str, settings, "audio_source");
+    }
+
+    auto encoder_settings = create_video_encoder_settings(settings);
+    for (auto &name : get_setting_names(encoder_settings)) {
+        append_setting(str, encoder_settings, name.c_str());
+    }
+    obs_data_release(encoder_settings);
+
+    return str;
+}
+
+// Filters on the same parent with the same encoder-relevant settings share a group.
+inline std::string make_group_key(obs_source_t *parent, obs_data_t *settings, uint32_t width, uint32_t height)
+{
+    return std::string(obs_source_get_uuid(parent)) + ":" + std::to_string(width) + "x" + std::to_string(height) +
+           ":" + normalize_encoder_settings(settings);
+}
+
+// Raw frame from view's video output (Connected only while latency tracing is enabled)
+void trace_video_frame(void *param, video_data *frame)
+{
+    auto group = (encoder_group_t *)param;
+    if (latency_trace_sample(&group->latency_trace, LATENCY_STAGE_VIEW)) {
+        latency_trace_record(&group->latency_trace, LATENCY_STAGE_VIEW, frame->timestamp, os_gettime_ns());
+    }
+}
+
+void destroy_encoder_group(encoder_group_t *group)
+{
+    if (group->audio_encoder) {
+        obs_encoder_release(group->audio_encoder);
+    }
+
+    if (group->video_encoder) {
+        obs_encoder_release(group->video_encoder);
+    }
+    encoder_pool_release(group->encoder_placement);
+
+    // After video encoder (Reader) released
+    frame_divider_destroy(group->frame_divider);
+
+    if (group->audio_bus) {
+        // Waits for running callback of the track
+        audio_bus_release(group->audio_bus, group->audio_track);
+    } else if (group->audio_output) {
+        audio_output_close(group->audio_output);
+    }
+
+    // Release shared audio capture after audio output (Reader) closed
+    audio_hub_release(group->audio_hub);
+
+    if (group->trace_video_connected) {
+        video_output_disconnect(group->video_output, trace_video_frame, group);
+    }
+
+    // Release shared view after video encoder (Reader) released
+    view_cache_release(group->view);
+
+    pthread_mutex_destroy(&group->audio_reader_mutex);
+
+    if (group->audio_drift.dropped || group->audio_drift.repeated) {
+        obs_log(
+            LOG_INFO, "%s: Audio drift corrected by %llu dropped and %llu repeated frames", group->name.c_str(),
+            (unsigned long long)group->audio_drift.dropped, (unsigned long long)group->audio_drift.repeated
+        );
+    }
+
+    obs_log(LOG_DEBUG, "%s: Encoder group destroyed", group->name.c_str());
+    delete group;
+}
+
+inline void setup_audio_source(encoder_group_t *group, filter_t *filter, obs_data_t *settings)
+{
+    group->audio_source_type = AUDIO_SOURCE_TYPE_SILENCE;
+    group->audio_channels = (speaker_layout)audio_output_get_channels(obs_get_audio());
+    group->samples_per_sec = audio_output_get_sample_rate(obs_get_audio());
+
+    if (obs_data_get_bool(settings, "custom_audio_source")) {
+        // Apply custom audio source
+        auto source_uuid = obs_data_get_string(settings, "audio_source");
+
+        if (strlen(source_uuid) && strcmp(source_uuid, "no_audio")) {
+            if (!strncmp(source_uuid, "master_track_", strlen("master_track_"))) {
+                // Use master audio track
+                size_t trackNo = 0;
+                sscanf(source_uuid, "master_track_%zu", &trackNo);
+                obs_log(LOG_INFO, "%s: Use master track %zu", group->name.c_str(), trackNo);
+
+                if (trackNo >= 1 && trackNo <= MAX_AUDIO_MIXES) {
+                    // Shared with other filters which use same track
+                    group->audio_hub = audio_hub_acquire_master(trackNo - 1);
+                    group->audio_source_type = AUDIO_SOURCE_TYPE_MASTER;
+                }
+
+            } else {
+                auto source = obs_get_source_by_uuid(source_uuid);
+                if (source) {
+                    // Use custom audio source
+                    obs_log(
+                        LOG_INFO, "%s: Use %s as an audio source", group->name.c_str(), obs_source_get_name(source)
+                    );
+
+                    // Shared with other filters which use same source (It forwards audio to output)
+                    group->audio_hub = audio_hub_acquire_source(source);
+                    group->audio_source_type = AUDIO_SOURCE_TYPE_CAPTURE;
+
+                    obs_source_release(source);
+                }
+            }
+        }
+
+    } else {
+        // Use filter's audio (Read from ring buffer of the creator filter)
+        obs_log(LOG_INFO, "%s: Use filter audio as an audio source", group->name.c_str());
+        group->audio_source_type = AUDIO_SOURCE_TYPE_FILTER;
+    }
+
+    // Read from latest frame
+    if (group->audio_hub) {
+        audio_ring_reader_attach(&group->audio_reader, audio_hub_get_ring(group->audio_hub));
+    } else if (group->audio_source_type == AUDIO_SOURCE_TYPE_FILTER) {
+        audio_ring_reader_attach(&group->audio_reader, &filter->audio_buffer);
+    }
+    audio_drift_reset(&group->audio_drift);
+
+    if (group->audio_source_type == AUDIO_SOURCE_TYPE_SILENCE) {
+        obs_log(LOG_INFO, "%s: Audio is disabled", group->name.c_str());
+    }
+}
+
+// Scale down to "output_height" with keeping aspect ratio (Never scale up)
+inline void get_output_size(
+    obs_data_t *settings, uint32_t width, uint32_t height, uint32_t *output_width, uint32_t *output_height
+)
+{
+    auto target_height = (uint32_t)obs_data_get_int(settings, "output_height");
+
+    if (!target_height || target_height >= height) {
+        *output_width = width;
+        *output_height = height;
+        return;
+    }
+
+    // Round up to a multiple of 2
+    *output_width = (uint32_t)((uint64_t)width * target_height / height);
+    *output_width += (*output_width & 1);
+    *output_height = target_height + (target_height & 1);
+}
+
+encoder_group_t *create_encoder_group(
+    filter_t *filter, obs_data_t *settings, const std::string &key, uint32_t width, uint32_t height
+)
+{
+    auto parent = obs_filter_get_parent(filter->source);
+
+    auto group = new encoder_group_t();
+    group->key = key;
+    group->name = obs_source_get_name(filter->source);
+    group->refs = 1;
+    group->width = width;
+    group->height = height;
+    pthread_mutex_init(&group->audio_reader_mutex, NULL);
+
+    // Open video output
+    // Shared with other groups which render the same parent source with the same parameters
+    view_cache_params_t view_params = {0};
+    view_params.width = width;
+    view_params.height = height;
+    get_output_size(settings, width, height, &view_params.output_width, &view_params.output_height);
+    view_params.scale_type = (obs_scale_type)obs_data_get_int(settings, "scale_type");
+    view_params.letterbox = obs_data_get_bool(settings, "resolution_lock");
+    view_params.output_format = (int)obs_data_get_int(settings, "output_format");
+    view_params.colorspace = (int)obs_data_get_int(settings, "output_colorspace");
+    view_params.range = (int)obs_data_get_int(settings, "output_range");
+
+    auto fps_divisor = (uint32_t)obs_data_get_int(settings, "frame_rate_divisor");
+    fps_divisor = fps_divisor ? fps_divisor : 1;
+
+    group->output_width = view_params.output_width;
+    group->output_height = view_params.output_height;
+
+    group->view = view_cache_acquire(parent, &view_params);
+    if (!group->view) {
+        obs_log(LOG_ERROR, "%s: Video output association failed", group->name.c_str());
+        destroy_encoder_group(group);
+        return nullptr;
+    }
+    group->video_output = view_cache_get_video(group->view);
+
+    if (latency_trace_enabled()) {
+        group->trace_video_connected = video_output_connect(group->video_output, NULL, trace_video_frame, group);
+    }
+
+    // Retrieve audio source
+    setup_audio_source(group, filter, settings);
+
+    if (obs_data_get_bool(settings, "audio_bus")) {
+        // Join shared audio bus (audio_bus_track_callback fills the assigned track only)
+        group->audio_bus = audio_bus_acquire(
+            group->audio_channels, group->samples_per_sec, audio_bus_track_callback, group, &group->audio_track
+        );
+        if (!group->audio_bus) {
+            obs_log(LOG_ERROR, "%s: Joining audio bus failed", group->name.c_str());
+            destroy_encoder_group(group);
+            return nullptr;
+        }
+        group->audio_output = audio_bus_get_output(group->audio_bus);
+        obs_log(LOG_INFO, "%s: Use audio bus track %zu", group->name.c_str(), group->audio_track + 1);
+    }
+
+    // Open audio output (Audio will be captured from filter source via audio_input_callback)
+    audio_output_info oi = {0};
+
+    oi.name = group->name.c_str();
+    oi.speakers = group->audio_channels;
+    oi.samples_per_sec = group->samples_per_sec;
+    oi.format = AUDIO_FORMAT_FLOAT_PLANAR;
+    oi.input_param = group;
+    oi.input_callback = audio_input_callback;
+
+    if (!group->audio_bus && audio_output_open(&group->audio_output, &oi) < 0) {
+        obs_log(LOG_ERROR, "%s: Opening audio output failed", group->name.c_str());
+        group->audio_output = NULL;
+        destroy_encoder_group(group);
+        return nullptr;
+    }
+
+    // Setup video encoder
+    auto video_encoder_id = obs_data_get_string(settings, "video_encoder");
+    auto video_encoder_settings = create_video_encoder_settings(settings);
+
+    if (!strcmp(video_encoder_id, ENCODER_POOL_AUTO_ID)) {
+        // Place on the least loaded hardware encoder
+        obs_video_info ovi = {0};
+        ovi.fps_den = 1;
+        obs_get_video_info(&ovi);
+        auto pixel_rate =
+            (uint64_t)group->output_width * group->output_height * ovi.fps_num / ovi.fps_den / fps_divisor;
+
+        group->encoder_placement = encoder_pool_acquire(pixel_rate, group->name.c_str());
+        if (!group->encoder_placement) {
+            obs_data_release(video_encoder_settings);
+            destroy_encoder_group(group);
+            return nullptr;
+        }
+        // Applied once (Later updates are merged into encoder's settings, so it's kept)
+        video_encoder_id = encoder_placement_get_id(group->encoder_placement);
+        encoder_placement_apply(group->encoder_placement, video_encoder_settings);
+    }
+
+    group->video_encoder =
+        obs_video_encoder_create(video_encoder_id, group->name.c_str(), video_encoder_settings, NULL);
+    obs_data_release(video_encoder_settings);
+    if (!group->video_encoder) {
+        obs_log(LOG_ERROR, "%s: Video encoder creation failed", group->name.c_str());
+        destroy_encoder_group(group);
+        return nullptr;
+    }
+    obs_encoder_set_scaled_size(group->video_encoder, 0, 0);
+
+    // Skip frames of canvas rate view (Timestamps stay in real time)
+    auto encoder_video = group->video_output;
+#if LIBOBS_API_VER >= MAKE_SEMANTIC_VERSION(30, 2, 0)
+    obs_encoder_set_frame_rate_divisor(group->video_encoder, fps_divisor);
+#else
+    if (fps_divisor > 1) {
+        group->frame_divider = frame_divider_create(group->video_output, fps_divisor, group->name.c_str());
+        if (!group->frame_divider) {
+            destroy_encoder_group(group);
+            return nullptr;
+        }
+        encoder_video = frame_divider_get_video(group->frame_divider);
+    }
+#endif
+    obs_encoder_set_video(group->video_encoder, encoder_video);
+
+    // Setup audo encoder
+    auto audio_encoder_id = obs_data_get_string(settings, "audio_encoder");
+    auto audio_bitrate = obs_data_get_int(settings, "audio_bitrate");
+    auto audio_encoder_settings = obs_encoder_defaults(audio_encoder_id);
+    obs_data_set_int(audio_encoder_settings, "bitrate", audio_bitrate);
+
+    // Track 0 of own output or the assigned track of the bus
+    group->audio_encoder = obs_audio_encoder_create(
+        audio_encoder_id, group->name.c_str(), audio_encoder_settings, group->audio_track, NULL
+    );
+    obs_data_release(audio_encoder_settings);
+    if (!group->audio_encoder) {
+        obs_log(LOG_ERROR, "%s: Audio encoder creation failed", group->name.c_str());
+        destroy_encoder_group(group);
+        return nullptr;
+    }
+    obs_encoder_set_audio(group->audio_encoder, group->audio_output);
+
+    obs_log(LOG_DEBUG, "%s: Encoder group created", group->name.c_str());
+    return group;
+}
+
+// NOTE: Call with groups_mutex
+inline void add_audio_feeder(encoder_group_t *group, filter_t *filter)
+{
+    if (group->audio_source_type == AUDIO_SOURCE_TYPE_FILTER) {
+        // Every member pushes filter's audio but the group reads only one of them
+        group->audio_feeders.push_back(filter);
+    }
+}
+
+// NOTE: Call with groups_mutex
+inline encoder_group_t *find_shared_group(filter_t *filter, const std::string &key)
+{
+    auto it = encoder_groups.find(key);
+    if (it == encoder_groups.end()) {
+        return nullptr;
+    }
+
+    auto group = it->second;
+    group->refs++;
+    add_audio_feeder(group, filter);
+    obs_log(LOG_INFO, "%s: Share encoders with %s", obs_source_get_name(filter->source), group->name.c_str());
+    return group;
+}
+
+encoder_group_t *encoder_group_acquire(filter_t *filter, obs_data_t *settings, uint32_t width, uint32_t height)
+{
+    auto parent = obs_filter_get_parent(filter->source);
+    // Adaptive bitrate controls own encoder
+    auto shared = obs_data_get_bool(settings, "share_encoders") && !obs_data_get_bool(settings, "adaptive_bitrate");
+    auto key = make_group_key(parent, settings, width, height);
+
+    encoder_group_t *group = nullptr;
+    if (shared) {
+        pthread_mutex_lock(&groups_mutex);
+        group = find_shared_group(filter, key);
+        pthread_mutex_unlock(&groups_mutex);
+        if (group) {
+            return group;
+        }
+    }
+
+    // Create without groups_mutex (Opening outputs and encoders takes a while)
+    auto created = create_encoder_group(filter, settings, key, width, height);
+    if (!created) {
+        return nullptr;
+    }
+
+    pthread_mutex_lock(&groups_mutex);
+
+    if (shared) {
+        // Another filter may have registered the same group meanwhile -> Join it and discard ours
+        group = find_shared_group(filter, key);
+        if (!group) {
+            encoder_groups[key] = created;
+        }
+    }
+
+    if (!group) {
+        group = created;
+        created = nullptr;
+        add_audio_feeder(group, filter);
+    }
+
+    pthread_mutex_unlock(&groups_mutex);
+
+    if (created) {
+        destroy_encoder_group(created);
+    }
+
+    return group;
+}
+
+void encoder_group_release(encoder_group_t *group, filter_t *filter)
+{
+    if (!group) {
+        return;
+    }
+
+    pthread_mutex_lock(&groups_mutex);
+
+    auto &feeders = group->audio_feeders;
+    feeders.erase(std::remove(feeders.begin(), feeders.end(), filter), feeders.end());
+
+    if (group->audio_reader.ring == &filter->audio_buffer && !feeders.empty()) {
+        // Hand over audio feeding to another member
+        pthread_mutex_lock(&group->audio_reader_mutex);
+        audio_ring_reader_attach(&group->audio_reader, &feeders.front()->audio_buffer);
+        audio_drift_reset(&group->audio_drift);
+        pthread_mutex_unlock(&group->audio_reader_mutex);
+    }
+
+    auto last = --group->refs == 0;
+    if (last) {
+        auto it = encoder_groups.find(group->key);
+        if (it != encoder_groups.end() && it->second == group) {
+            encoder_groups.erase(it);
+        }
+    }
+
+    pthread_mutex_unlock(&groups_mutex);
+
+    if (last) {
+        destroy_encoder_group(group);
+    }
+}
+
+// Group still matches the settings and size (e.g. Encoders kept by warm standby)
+bool encoder_group_matches(
+    encoder_group_t *group, filter_t *filter, obs_data_t *settings, uint32_t width, uint32_t height
+)
+{
+    auto parent = obs_filter_get_parent(filter->source);
+    auto key = make_group_key(parent, settings, width, height);
+
+    pthread_mutex_lock(&groups_mutex);
+    auto matches = group->key == key;
+    pthread_mutex_unlock(&groups_mutex);
+
+    return matches;
+}
+
+inline bool encoder_group_shared(encoder_group_t *group)
+{
+    pthread_mutex_lock(&groups_mutex);
+    auto shared = group->refs > 1;
+    pthread_mutex_unlock(&groups_mutex);
+    return shared;
+}
+
+// Encoder applies bitrate changes while encoding (Others have no update callback or ignore it)
+inline bool supports_live_update(obs_encoder_t *encoder)
+{
+    return (obs_get_encoder_caps(obs_encoder_get_id(encoder)) & OBS_ENCODER_CAP_DYN_BITRATE) != 0;
+}
+
+// Apply live-updatable encoder settings (e.g. bitrate) without recreating encoders.
+// "changes" has the live settings which changed.
+// Returns false when the group is shared with other filters (They have own settings)
+// or an affected encoder can't apply them while encoding.
+bool encoder_group_update(encoder_group_t *group, filter_t *filter, obs_data_t *settings, obs_data_t *changes)
+{
+    auto video_changed = obs_data_has_user_value(changes, "bitrate") ||
+                         obs_data_has_user_value(changes, "max_bitrate") ||
+                         obs_data_has_user_value(changes, "buffer_size");
+    auto audio_changed = obs_data_has_user_value(changes, "audio_bitrate");
+
+    if ((video_changed && !supports_live_update(group->video_encoder)) ||
+        (audio_changed && !supports_live_update(group->audio_encoder))) {
+        obs_log(LOG_INFO, "%s: Encoders don't support live update", group->name.c_str());
+        return false;
+    }
+
+    auto parent = obs_filter_get_parent(filter->source);
+    auto key = make_group_key(parent, settings, group->width, group->height);
+
+    pthread_mutex_lock(&groups_mutex);
+
+    if (group->refs > 1) {
+        pthread_mutex_unlock(&groups_mutex);
+        return false;
+    }
+
+    // Re-register with new key
+    auto it = encoder_groups.find(group->key);
+    if (it != encoder_groups.end() && it->second == group) {
+        encoder_groups.erase(it);
+        if (!encoder_groups.count(key)) {
+            encoder_groups[key] = group;
+        }
+    }
+    group->key = key;
+
+    pthread_mutex_unlock(&groups_mutex);
+
+    // Push changed settings only (Encoders merge them into current settings)
+    if (video_changed) {
+        auto video_encoder_settings = obs_data_create();
+        for (auto name : {"bitrate", "max_bitrate", "buffer_size"}) {
+            if (obs_data_has_user_value(changes, name)) {
+                obs_data_set_int(video_encoder_settings, name, obs_data_get_int(changes, name));
+            }
+        }
+        obs_encoder_update(group->video_encoder, video_encoder_settings);
+        obs_data_release(video_encoder_settings);
+    }
+
+    if (audio_changed) {
+        auto audio_encoder_settings = obs_data_create();
+        obs_data_set_int(audio_encoder_settings, "bitrate", obs_data_get_int(changes, "audio_bitrate"));
+        obs_encoder_update(group->audio_encoder, audio_encoder_settings);
+        obs_data_release(audio_encoder_settings);
+    }
+
+    obs_log(LOG_INFO, "%s: Encoder settings updated", group->name.c_str());
+    return true;
+}
+
+// NOTE: Call when encoders were created or updated with the settings.
+void reset_adaptive_bitrate(filter_t *filter, obs_data_t *settings)
+{
+    auto encoder_settings = create_video_encoder_settings(settings);
+    auto max_bitrate = (uint32_t)obs_data_get_int(encoder_settings, "bitrate");
+    obs_data_release(encoder_settings);
+
+    filter->adaptive_bitrate = obs_data_get_bool(settings, "adaptive_bitrate") && max_bitrate > 0;
+    if (filter->adaptive_bitrate && filter->encoders && !supports_live_update(filter->encoders->video_encoder)) {
+        obs_log(
+            LOG_WARNING, "%s: Adaptive bitrate is disabled because %s can't change bitrate while encoding",
+            obs_source_get_name(filter->source), obs_encoder_get_id(filter->encoders->video_encoder)
+        );
+        filter->adaptive_bitrate = false;
+    }
+    auto min_bitrate = (uint32_t)obs_data_get_int(settings, "abr_min_bitrate");
+    bitrate_control_reset(&filter->bitrate_control, min_bitrate, max_bitrate);
+}
+
+// Worst drop ratio of destinations since the previous sample (Sum of them hides one bad destination among good ones)
+static float worst_drop_ratio(filter_t *filter, const telemetry_sample_t *sample)
+{
+    // Supervisor is the writer, so the latest sample is the previous one
+    telemetry_sample_t previous;
+    if (!telemetry_ring_read(&filter->telemetry, &previous, 1)) {
+        return 0.0f;
+    }
+
+    auto worst = 0.0f;
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        auto current = &sample->destinations[i];
+        auto total = current->total_frames - previous.destinations[i].total_frames;
+        auto dropped = current->frames_dropped - previous.destinations[i].frames_dropped;
+
+        // Counters go back when outputs are restarted
+        if (!current->active || total <= 0 || dropped < 0) {
+            continue;
+        }
+
+        auto ratio = (float)dropped / (float)total;
+        worst = ratio > worst ? ratio : worst;
+    }
+    return worst;
+}
+
+// Called by supervisor with each telemetry sample. Lower or raise video bitrate following the worst destination.
+void adapt_bitrate(filter_t *filter, telemetry_sample_t *sample)
+{
+    if (!filter->adaptive_bitrate || !filter->encoders || !sample->active_destinations) {
+        return;
+    }
+
+    // Congestion of one member must not control encoders of others
+    // (Groups with adaptive bitrate aren't registered for sharing, so this is only a guard)
+    if (encoder_group_shared(filter->encoders)) {
+        return;
+    }
+
+    auto control = &filter->bitrate_control;
+    auto previous = control->bitrate;
+    sample->bitrate_decision = bitrate_control_step(control, sample->congestion, worst_drop_ratio(filter, sample));
+    sample->video_bitrate = control->bitrate;
+
+    if (control->bitrate == previous) {
+        return;
+    }
+
+    obs_log(
+        LOG_INFO, "%s: Adaptive bitrate %s to %u kbps (Congestion %.2f)", obs_source_get_name(filter->source),
+        sample->bitrate_decision == BITRATE_DECISION_LOWERED ? "lowered" : "raised", control->bitrate,
+        sample->congestion
+    );
+
+    // Encoders accept bitrate change while encoding
+    auto encoder_settings = obs_data_create();
+    obs_data_set_int(encoder_settings, "bitrate", control->bitrate);
+    obs_encoder_update(filter->encoders->video_encoder, encoder_settings);
+    obs_data_release(encoder_settings);
+}
+
+// Default sessions of hardware encoders (Overridden by ENCODER_POOL_JSON_NAME)
+// NOTE: Session limits depend on driver and GPU, and the second GPU must be added in config file.
+static const struct {
+    const char *encoder_id;
+    uint32_t sessions;
+} default_hardware_encoders[] = {
+    {"jim_nvenc", 8},
+    {"obs_qsv11_v2", 4},
+    {"h264_texture_amf", 4},
+    {"com.apple.videotoolbox.videoencoder.ave.avc", 4},
+};
+
+// Devices for "Auto (Hardware, balanced)" encoder
+void encoder_pool_load()
+{
+    auto path = obs_module_get_config_path(obs_current_module(), ENCODER_POOL_JSON_NAME);
+    auto config = obs_data_create_from_json_file(path);
+
+    if (!config) {
+        // Write default config for discoverability
+        config = obs_data_create();
+        auto devices = obs_data_array_create();
+        for (auto &encoder : default_hardware_encoders) {
+            if (!obs_get_encoder_codec(encoder.encoder_id)) {
+                continue;
+            }
+            auto device = obs_data_create();
+            obs_data_set_string(device, "encoder", encoder.encoder_id);
+            obs_data_set_int(device, "gpu", !strcmp(encoder.encoder_id, "jim_nvenc") ? 0 : -1);
+            obs_data_set_int(device, "sessions", encoder.sessions);
+            obs_data_array_push_back(devices, device);
+            obs_data_release(device);
+        }
+        obs_data_set_array(config, "devices", devices);
+        obs_data_array_release(devices);
+        obs_data_set_int(config, "software_sessions", ENCODER_POOL_DEFAULT_SOFTWARE_SESSIONS);
+
+        auto config_dir_path = obs_module_get_config_path(obs_current_module(), "");
+        os_mkdirs(config_dir_path);
+        bfree(config_dir_path);
+        obs_data_save_json_safe(config, path, "tmp", "bak");
+    }
+    bfree(path);
+
+    obs_data_set_default_int(config, "software_sessions", ENCODER_POOL_DEFAULT_SOFTWARE_SESSIONS);
+    encoder_pool_set_software_sessions((uint32_t)obs_data_get_int(config, "software_sessions"));
+
+    auto devices = obs_data_get_array(config, "devices");
+    for (size_t i = 0; i < obs_data_array_count(devices); i++) {
+        auto device = obs_data_array_item(devices, i);
+        obs_data_set_default_int(device, "gpu", -1);
+        encoder_pool_add_device(
+            obs_data_get_string(device, "encoder"), (int)obs_data_get_int(device, "gpu"),
+            (uint32_t)obs_data_get_int(device, "sessions")
+        );
+        obs_data_release(device);
+    }
+    obs_data_array_release(devices);
+
+    obs_data_release(config);
+}
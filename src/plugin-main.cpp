@@ -20,141 +20,197 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <plugin-support.h>
 #include <obs-frontend-api.h>
 #include <util/config-file.h>
-#include <util/deque.h>
 #include <util/threading.h>
 #include <util/platform.h>
 #include "plugin-main.hpp"
+#include "audio/audio-mix.hpp"
+#include "supervisor/scene-graph.hpp"
+#include "supervisor/worker-pool.hpp"
+#include "supervisor/reconnect.hpp"
+#include "supervisor/recently-store.hpp"
+#include "supervisor/startup.hpp"
+#include "encoder/encoder-pool.hpp"
+#include "ui/properties-cache.hpp"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
-void stop_output(filter_t *filter)
+inline void wake_supervisor(filter_t *filter, uint32_t events)
 {
-    obs_source_t *parent = obs_filter_get_parent(filter->source);
-    filter->connect_attempting_at = 0;
-
-    if (filter->stream_output) {
-        if (filter->output_active) {
-            obs_source_dec_showing(parent);
-            obs_output_stop(filter->stream_output);
-        }
+    filter->supervise_events.fetch_or(events, std::memory_order_release);
+}
 
-        obs_output_release(filter->stream_output);
-        filter->stream_output = NULL;
-    }
+// Output signals: "start", "stop", "reconnect" and "reconnect_success"
+void output_state_changed(void *data, calldata_t *)
+{
+    wake_supervisor((filter_t *)data, SUPERVISE_EVENT_OUTPUT);
+}
 
-    if (filter->service) {
-        obs_service_release(filter->service);
-        filter->service = NULL;
+void connect_output_signals(filter_t *filter, obs_output_t *output, bool connect)
+{
+    auto handler = obs_output_get_signal_handler(output);
+    for (auto signal : {"start", "stop", "reconnect", "reconnect_success"}) {
+        if (connect) {
+            signal_handler_connect(handler, signal, output_state_changed, filter);
+        } else {
+            signal_handler_disconnect(handler, signal, output_state_changed, filter);
+        }
     }
+}
 
-    if (filter->audio_encoder) {
-        obs_encoder_release(filter->audio_encoder);
-        filter->audio_encoder = NULL;
-    }
+void stop_destination(filter_t *filter, size_t index)
+{
+    auto dest = &filter->destinations[index];
+    dest->connect_attempting_at = 0;
 
-    if (filter->video_encoder) {
-        obs_encoder_release(filter->video_encoder);
-        filter->video_encoder = NULL;
-    }
+    if (dest->stream_output) {
+        // Intentional stopping doesn't need supervision
+        connect_output_signals(filter, dest->stream_output, false);
 
-    if (filter->audio_source_type == AUDIO_SOURCE_TYPE_CAPTURE) {
-        if (filter->audio_source) {
-            auto source = obs_weak_source_get_source(filter->audio_source);
-            if (source) {
-                obs_source_remove_audio_capture_callback(source, audio_capture_callback, filter);
-                obs_source_release(source);
-            }
-            obs_weak_source_release(filter->audio_source);
-            filter->audio_source = NULL;
+        if (dest->active) {
+            obs_output_stop(dest->stream_output);
         }
 
-    } else if (filter->audio_source_type == AUDIO_SOURCE_TYPE_MASTER) {
-        obs_remove_raw_audio_callback(filter->audio_mix_idx, master_audio_callback, filter);
+        obs_output_release(dest->stream_output);
+        dest->stream_output = NULL;
     }
-    filter->audio_source_type = AUDIO_SOURCE_TYPE_SILENCE;
 
-    if (filter->audio_output) {
-        audio_output_close(filter->audio_output);
-        filter->audio_output = NULL;
+    if (dest->service) {
+        obs_service_release(dest->service);
+        dest->service = NULL;
     }
 
-    if (filter->view) {
-        obs_view_set_source(filter->view, 0, NULL);
-        obs_view_remove(filter->view);
-        obs_view_destroy(filter->view);
-        filter->view = NULL;
+    if (dest->active) {
+        dest->active = false;
+        obs_log(LOG_INFO, "%s: Stopping stream output #%zu succeeded", obs_source_get_name(filter->source), index + 1);
     }
+}
 
-    filter->audio_buffer_frames = 0;
-    filter->audio_skip = 0;
-    deque_free(&filter->audio_buffer);
+// Stop destinations and recording (View and encoders are kept)
+inline void stop_streams(filter_t *filter)
+{
+    obs_source_t *parent = obs_filter_get_parent(filter->source);
+
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        stop_destination(filter, i);
+
+        // Backoff restarts from the beginning
+        filter->destinations[i].reconnect_attempts = 0;
+        filter->destinations[i].reconnect_at = 0;
+    }
+
+    stop_recording(filter);
+    filter->recording.restart_attempts = 0;
+    filter->recording.restart_at = 0;
 
     if (filter->output_active) {
+        obs_source_dec_showing(parent);
+        telemetry_log_summary(filter);
         filter->output_active = false;
         obs_log(LOG_INFO, "%s: Stopping stream output succeeded", obs_source_get_name(filter->source));
     }
+
+    obs_data_release(filter->active_settings);
+    filter->active_settings = NULL;
 }
 
-#define FTL_PROTOCOL "ftl"
-#define RTMP_PROTOCOL "rtmp"
+void stop_output(filter_t *filter)
+{
+    stop_streams(filter);
 
-void start_output(filter_t *filter, obs_data_t *settings)
+    // Encoders are destroyed when no other filters share them
+    if (filter->encoders) {
+        encoder_group_release(filter->encoders, filter);
+        filter->encoders = NULL;
+    }
+    filter->audio_source_type = AUDIO_SOURCE_TYPE_SILENCE;
+    filter->standby = false;
+}
+
+// Remove "server", "key" and additional destinations from the settings
+void erase_destination_settings(obs_data_t *settings)
 {
-    // Force release references
-    stop_output(filter);
+    obs_data_erase(settings, "server");
+    obs_data_erase(settings, "key");
+
+    for (size_t i = 1; i < MAX_STREAM_DESTINATIONS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "stream_%zu", i + 1);
+        obs_data_erase(settings, name);
+        snprintf(name, sizeof(name), "server_%zu", i + 1);
+        obs_data_erase(settings, name);
+        snprintf(name, sizeof(name), "key_%zu", i + 1);
+        obs_data_erase(settings, name);
+    }
+}
 
-    // Abort when obs initializing or filter disabled.
-    if (!obs_initialized() || !obs_source_enabled(filter->source)) {
-        return;
+// Startup settings are referred by supervisor only (Never affect encoders or outputs)
+void erase_startup_settings(obs_data_t *settings)
+{
+    obs_data_erase(settings, "startup_priority");
+    obs_data_erase(settings, "warm_standby");
+}
+
+// Returns new reference of destination's settings or NULL when destination is not configured.
+obs_data_t *get_destination_settings(obs_data_t *settings, size_t index)
+{
+    if (index == 0) {
+        // Primary destination uses filter settings as is
+        if (!strlen(obs_data_get_string(settings, "server"))) {
+            return NULL;
+        }
+        obs_data_addref(settings);
+        return settings;
     }
 
-    // Retrieve filter source
-    auto parent = obs_filter_get_parent(filter->source);
-    if (!parent) {
-        obs_log(LOG_ERROR, "%s: Filter source not found", obs_source_get_name(filter->source));
-        return;
+    char name[32];
+    snprintf(name, sizeof(name), "stream_%zu", index + 1);
+    if (!obs_data_get_bool(settings, name)) {
+        return NULL;
     }
 
-    obs_video_info ovi = {0};
-    if (!obs_get_video_info(&ovi)) {
-        // Abort when no video situation
-        return;
+    snprintf(name, sizeof(name), "server_%zu", index + 1);
+    auto server = obs_data_get_string(settings, name);
+    if (!strlen(server)) {
+        return NULL;
     }
 
-    // Round up to a multiple of 2
-    filter->width = obs_source_get_width(parent);
-    filter->width += (filter->width & 1);
-    // Round up to a multiple of 2
-    filter->height = obs_source_get_height(parent);
-    filter->height += (filter->height & 1);
+    auto dest_settings = obs_data_create();
+    obs_data_apply(dest_settings, settings);
+    obs_data_set_string(dest_settings, "server", server);
+    snprintf(name, sizeof(name), "key_%zu", index + 1);
+    obs_data_set_string(dest_settings, "key", obs_data_get_string(settings, name));
 
-    ovi.base_width = filter->width;
-    ovi.base_height = filter->height;
-    ovi.output_width = filter->width;
-    ovi.output_height = filter->height;
+    return dest_settings;
+}
 
-    if (filter->width == 0 || filter->height == 0 || ovi.fps_den == 0 || ovi.fps_num == 0) {
-        // Abort when invalid video parameters situation
-        return;
-    }
+// Streaming to at least primary destination or recording
+inline bool outputs_configured(obs_data_t *settings)
+{
+    return strlen(obs_data_get_string(settings, "server")) || recording_enabled(settings);
+}
 
-    // Update active revision with stored settings.
-    filter->active_settings_rev = filter->stored_settings_rev;
+#define FTL_PROTOCOL "ftl"
+#define RTMP_PROTOCOL "rtmp"
+
+// Create service and stream output for the destination (Encoders are attached later)
+bool create_destination(filter_t *filter, size_t index, obs_data_t *dest_settings)
+{
+    auto dest = &filter->destinations[index];
 
     // Create service - We always use "rtmp_custom" as service
-    filter->service = obs_service_create("rtmp_custom", obs_source_get_name(filter->source), settings, NULL);
-    if (!filter->service) {
-        obs_log(LOG_ERROR, "%s: Service creation failed", obs_source_get_name(filter->source));
-        return;
+    dest->service = obs_service_create("rtmp_custom", obs_source_get_name(filter->source), dest_settings, NULL);
+    if (!dest->service) {
+        obs_log(LOG_ERROR, "%s: Service #%zu creation failed", obs_source_get_name(filter->source), index + 1);
+        return false;
     }
-    obs_service_apply_encoder_settings(filter->service, settings, NULL);
+    obs_service_apply_encoder_settings(dest->service, dest_settings, NULL);
 
     // Determine output type
-    auto type = obs_service_get_preferred_output_type(filter->service);
+    auto type = obs_service_get_preferred_output_type(dest->service);
     if (!type) {
         type = "rtmp_output";
-        auto url = obs_service_get_connect_info(filter->service, OBS_SERVICE_CONNECT_INFO_SERVER_URL);
+        auto url = obs_service_get_connect_info(dest->service, OBS_SERVICE_CONNECT_INFO_SERVER_URL);
         if (url != NULL && !strncmp(url, FTL_PROTOCOL, strlen(FTL_PROTOCOL))) {
             type = "ftl_output";
         } else if (url != NULL && strncmp(url, RTMP_PROTOCOL, strlen(RTMP_PROTOCOL))) {
@@ -163,143 +219,168 @@ void start_output(filter_t *filter, obs_data_t *settings)
     }
 
     // Create stream output
-    filter->stream_output = obs_output_create(type, obs_source_get_name(filter->source), settings, NULL);
-    if (!filter->stream_output) {
-        obs_log(LOG_ERROR, "%s: Stream output creation failed", obs_source_get_name(filter->source));
-        return;
+    dest->stream_output = obs_output_create(type, obs_source_get_name(filter->source), dest_settings, NULL);
+    if (!dest->stream_output) {
+        obs_log(LOG_ERROR, "%s: Stream output #%zu creation failed", obs_source_get_name(filter->source), index + 1);
+        return false;
     }
-    obs_output_set_reconnect_settings(filter->stream_output, OUTPUT_MAX_RETRIES, OUTPUT_RETRY_DELAY_SECS);
-    obs_output_set_service(filter->stream_output, filter->service);
-    filter->connect_attempting_at = os_gettime_ns();
+    obs_output_set_reconnect_settings(dest->stream_output, OUTPUT_MAX_RETRIES, OUTPUT_RETRY_DELAY_SECS);
+    obs_output_set_service(dest->stream_output, dest->service);
+    connect_output_signals(filter, dest->stream_output, true);
+    dest->connect_attempting_at = os_gettime_ns();
 
-    // Open video output
-    // Create view and associate it with filter source
-    filter->view = obs_view_create();
+    return true;
+}
 
-    obs_view_set_source(filter->view, 0, parent);
-    filter->video_output = obs_view_add2(filter->view, &ovi);
-    if (!filter->video_output) {
-        obs_log(LOG_ERROR, "%s: Video output association failed", obs_source_get_name(filter->source));
-        return;
+// Attach destination's output to filter's encoders and start it
+bool start_destination(filter_t *filter, size_t index)
+{
+    auto dest = &filter->destinations[index];
+
+    obs_output_set_video_encoder(dest->stream_output, filter->encoders->video_encoder);
+    obs_output_set_audio_encoder(dest->stream_output, filter->encoders->audio_encoder, 0);
+
+    // Start stream output
+    if (obs_output_start(dest->stream_output)) {
+        dest->active = true;
+        obs_log(LOG_INFO, "%s: Starting stream output #%zu succeeded", obs_source_get_name(filter->source), index + 1);
+    } else {
+        obs_log(LOG_ERROR, "%s: Starting stream output #%zu failed", obs_source_get_name(filter->source), index + 1);
     }
 
-    // Retrieve audio source
-    filter->audio_source_type = AUDIO_SOURCE_TYPE_SILENCE;
-    filter->audio_source = NULL;
-    filter->audio_mix_idx = 0;
-    filter->audio_channels = (speaker_layout)audio_output_get_channels(obs_get_audio());
-    filter->samples_per_sec = audio_output_get_sample_rate(obs_get_audio());
-    filter->audio_buffer_frames = 0;
-    filter->audio_skip = 0;
-
-    if (obs_data_get_bool(settings, "custom_audio_source")) {
-        // Apply custom audio source
-        auto source_uuid = obs_data_get_string(settings, "audio_source");
-
-        if (strlen(source_uuid) && strcmp(source_uuid, "no_audio")) {
-            if (!strncmp(source_uuid, "master_track_", strlen("master_track_"))) {
-                // Use master audio track
-                size_t trackNo = 0;
-                sscanf(source_uuid, "master_track_%zu", &trackNo);
-                obs_log(LOG_INFO, "%s: Use master track %zu", obs_source_get_name(filter->source), trackNo);
-
-                if (trackNo <= MAX_AUDIO_MIXES) {
-                    filter->audio_mix_idx = trackNo - 1;
-
-                    audio_convert_info conv = {0};
-                    conv.format = AUDIO_FORMAT_FLOAT_PLANAR;
-                    conv.samples_per_sec = filter->samples_per_sec;
-                    conv.speakers = filter->audio_channels;
-                    conv.allow_clipping = true;
-
-                    filter->audio_source_type = AUDIO_SOURCE_TYPE_MASTER;
-
-                    obs_add_raw_audio_callback(filter->audio_mix_idx, &conv, master_audio_callback, filter);
-                }
+    return dest->active;
+}
 
-            } else {
-                auto source = obs_get_source_by_uuid(source_uuid);
-                if (source) {
-                    // Use custom audio source
-                    obs_log(
-                        LOG_INFO, "%s: Use %s as an audio source", obs_source_get_name(filter->source),
-                        obs_source_get_name(source)
-                    );
-                    filter->audio_source = obs_source_get_weak_source(source);
-                    filter->audio_source_type = AUDIO_SOURCE_TYPE_CAPTURE;
-
-                    if (!filter->audio_source) {
-                        obs_log(LOG_ERROR, "%s: Audio source retrieval failed", obs_source_get_name(filter->source));
-                        obs_source_release(source);
-                        return;
-                    }
-
-                    // Register audio capture callback (It forwards audio to output)
-                    obs_source_add_audio_capture_callback(source, audio_capture_callback, filter);
-
-                    obs_source_release(source);
-                }
-            }
+// Reconnect only one destination (Encoders keep running for other destinations)
+void restart_destination(filter_t *filter, size_t index)
+{
+    stop_destination(filter, index);
+
+    auto settings = obs_source_get_settings(filter->source);
+    auto dest_settings = get_destination_settings(settings, index);
+    if (dest_settings) {
+        if (create_destination(filter, index, dest_settings)) {
+            start_destination(filter, index);
         }
+        obs_data_release(dest_settings);
+    }
+    obs_data_release(settings);
+}
 
+// Acquire view, audio output and encoders for current source size.
+// Encoders kept by warm standby are reused while they still match the settings.
+bool prepare_encoders(filter_t *filter, obs_data_t *settings)
+{
+    // Retrieve filter source
+    auto parent = obs_filter_get_parent(filter->source);
+    if (!parent) {
+        obs_log(LOG_ERROR, "%s: Filter source not found", obs_source_get_name(filter->source));
+        return false;
+    }
+
+    obs_video_info ovi = {0};
+    if (!obs_get_video_info(&ovi)) {
+        // Abort when no video situation
+        return false;
+    }
+
+    // Locked resolution doesn't follow source size (Source is letterboxed)
+    filter->resolution_locked = obs_data_get_bool(settings, "resolution_lock");
+    if (filter->resolution_locked) {
+        filter->width = (uint32_t)obs_data_get_int(settings, "locked_width");
+        filter->height = (uint32_t)obs_data_get_int(settings, "locked_height");
     } else {
-        // Use filter's audio
-        obs_log(LOG_INFO, "%s: Use filter audio as an audio source", obs_source_get_name(filter->source));
-        filter->audio_source_type = AUDIO_SOURCE_TYPE_FILTER;
+        filter->width = obs_source_get_width(parent);
+        filter->height = obs_source_get_height(parent);
     }
+    // Round up to a multiple of 2
+    filter->width += (filter->width & 1);
+    // Round up to a multiple of 2
+    filter->height += (filter->height & 1);
 
-    if (filter->audio_source_type == AUDIO_SOURCE_TYPE_SILENCE) {
-        obs_log(LOG_INFO, "%s: Audio is disabled", obs_source_get_name(filter->source));
+    if (filter->width == 0 || filter->height == 0 || ovi.fps_den == 0 || ovi.fps_num == 0) {
+        // Abort when invalid video parameters situation
+        return false;
     }
 
-    // Open audio output (Audio will be captured from filter source via audio_input_callback)
-    audio_output_info oi = {0};
+    if (filter->encoders) {
+        if (encoder_group_matches(filter->encoders, filter, settings, filter->width, filter->height)) {
+            obs_log(LOG_INFO, "%s: Use encoders of warm standby", obs_source_get_name(filter->source));
+            return true;
+        }
+        encoder_group_release(filter->encoders, filter);
+        filter->encoders = NULL;
+        filter->audio_source_type = AUDIO_SOURCE_TYPE_SILENCE;
+    }
+
+    // Create or share view, audio output and encoders
+    filter->encoders = encoder_group_acquire(filter, settings, filter->width, filter->height);
+    if (!filter->encoders) {
+        return false;
+    }
+    filter->audio_source_type = filter->encoders->audio_source_type;
+    return true;
+}
 
-    oi.name = obs_source_get_name(filter->source);
-    oi.speakers = filter->audio_channels;
-    oi.samples_per_sec = filter->samples_per_sec;
-    oi.format = AUDIO_FORMAT_FLOAT_PLANAR;
-    oi.input_param = filter;
-    oi.input_callback = audio_input_callback;
+void start_output(filter_t *filter, obs_data_t *settings)
+{
+    // Force release references (Except encoders of warm standby)
+    if (filter->standby) {
+        stop_streams(filter);
+        filter->standby = false;
+    } else {
+        stop_output(filter);
+    }
 
-    if (audio_output_open(&filter->audio_output, &oi) < 0) {
-        obs_log(LOG_ERROR, "%s: Opening audio output failed", obs_source_get_name(filter->source));
+    // Abort when obs initializing or filter disabled.
+    if (!obs_initialized() || !obs_source_enabled(filter->source)) {
         return;
     }
 
-    // Setup video encoder
-    auto video_encoder_id = obs_data_get_string(settings, "video_encoder");
-    filter->video_encoder =
-        obs_video_encoder_create(video_encoder_id, obs_source_get_name(filter->source), settings, NULL);
-    if (!filter->video_encoder) {
-        obs_log(LOG_ERROR, "%s: Video encoder creation failed", obs_source_get_name(filter->source));
+    if (!prepare_encoders(filter, settings)) {
         return;
     }
-    obs_encoder_set_scaled_size(filter->video_encoder, 0, 0);
-    obs_encoder_set_video(filter->video_encoder, filter->video_output);
-    obs_output_set_video_encoder(filter->stream_output, filter->video_encoder);
+    reset_adaptive_bitrate(filter, settings);
 
-    // Setup audo encoder
-    auto audio_encoder_id = obs_data_get_string(settings, "audio_encoder");
-    auto audio_bitrate = obs_data_get_int(settings, "audio_bitrate");
-    auto audio_encoder_settings = obs_encoder_defaults(audio_encoder_id);
-    obs_data_set_int(audio_encoder_settings, "bitrate", audio_bitrate);
+    // Update active revision with stored settings.
+    filter->active_settings_rev = filter->stored_settings_rev;
 
-    // Use track 0 only.
-    filter->audio_encoder = obs_audio_encoder_create(
-        audio_encoder_id, obs_source_get_name(filter->source), audio_encoder_settings, 0, NULL
-    );
-    obs_data_release(audio_encoder_settings);
-    if (!filter->audio_encoder) {
-        obs_log(LOG_ERROR, "%s: Audio encoder creation failed", obs_source_get_name(filter->source));
-        return;
+    // Keep snapshot for diff on next settings change (Settings object is modified in place)
+    filter->active_settings = obs_data_create();
+    obs_data_apply(filter->active_settings, settings);
+
+    // Create services and stream outputs
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        auto dest_settings = get_destination_settings(settings, i);
+        if (!dest_settings) {
+            continue;
+        }
+
+        auto created = create_destination(filter, i, dest_settings);
+        obs_data_release(dest_settings);
+
+        if (!created) {
+            return;
+        }
     }
-    obs_encoder_set_audio(filter->audio_encoder, filter->audio_output);
-    obs_output_set_audio_encoder(filter->stream_output, filter->audio_encoder, 0);
 
-    // Start stream output
-    if (obs_output_start(filter->stream_output)) {
+    // Recording failure doesn't abort streaming
+    if (recording_enabled(settings)) {
+        create_recording(filter, settings);
+    }
+
+    // Start stream outputs (All destinations are fed from same encoders)
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        if (filter->destinations[i].stream_output && start_destination(filter, i)) {
+            filter->output_active = true;
+        }
+    }
+
+    if (filter->recording.output && start_recording(filter)) {
         filter->output_active = true;
+    }
+
+    if (filter->output_active) {
         obs_source_inc_showing(obs_filter_get_parent(filter->source));
         obs_log(LOG_INFO, "%s: Starting stream output succeeded", obs_source_get_name(filter->source));
     } else {
@@ -307,6 +388,31 @@ void start_output(filter_t *filter, obs_data_t *settings)
     }
 }
 
+// Stop outputs but keep view and encoders, so that showing the filter again starts streaming at once
+void standby_output(filter_t *filter)
+{
+    stop_streams(filter);
+
+    auto settings = obs_source_get_settings(filter->source);
+    filter->standby_settings_rev = filter->stored_settings_rev;
+
+    if (obs_initialized() && outputs_configured(settings) && prepare_encoders(filter, settings)) {
+        filter->standby = true;
+        obs_log(LOG_INFO, "%s: Warm standby", obs_source_get_name(filter->source));
+    } else {
+        stop_output(filter);
+    }
+
+    obs_data_release(settings);
+}
+
+// Settings which supervisor refers without fetching settings
+inline void load_supervise_settings(filter_t *filter, obs_data_t *settings)
+{
+    filter->startup_priority = obs_data_get_int(settings, "startup_priority");
+    filter->warm_standby = obs_data_get_bool(settings, "warm_standby") && outputs_configured(settings);
+}
+
 void update(void *data, obs_data_t *settings)
 {
     auto filter = (filter_t *)data;
@@ -315,15 +421,11 @@ void update(void *data, obs_data_t *settings)
     // It's unwelcome to do stopping output during attempting connect to service.
     // So we just count up revision (Settings will be applied on video_tick())
     filter->stored_settings_rev++;
+    load_supervise_settings(filter, settings);
+    wake_supervisor(filter, SUPERVISE_EVENT_SETTINGS);
 
-    // Save settings as default
-    auto config_dir_path = obs_module_get_config_path(obs_current_module(), "");
-    os_mkdirs(config_dir_path);
-    bfree(config_dir_path);
-
-    auto path = obs_module_get_config_path(obs_current_module(), SETTINGS_JSON_NAME);
-    obs_data_save_json_safe(settings, path, "tmp", "bak");
-    bfree(path);
+    // Save settings as default (Written by background thread after settings got quiet)
+    recently_store_save(settings);
 
     obs_log(LOG_INFO, "%s: Filter updated", obs_source_get_name(filter->source));
 }
@@ -331,13 +433,11 @@ void update(void *data, obs_data_t *settings)
 inline void load_recently(obs_data_t *settings)
 {
     obs_log(LOG_DEBUG, "Recently settings loading");
-    auto path = obs_module_get_config_path(obs_current_module(), SETTINGS_JSON_NAME);
-    auto recently_settings = obs_data_create_from_json_file(path);
-    bfree(path);
+    auto recently_settings = recently_store_load();
 
     if (recently_settings) {
-        obs_data_erase(recently_settings, "server");
-        obs_data_erase(recently_settings, "key");
+        erase_destination_settings(recently_settings);
+        obs_data_erase(recently_settings, "recording");
         obs_data_erase(recently_settings, "custom_audio_source");
         obs_data_erase(recently_settings, "audio_source");
         obs_data_apply(settings, recently_settings);
@@ -347,24 +447,47 @@ inline void load_recently(obs_data_t *settings)
     obs_log(LOG_INFO, "Recently settings loaded");
 }
 
+void filter_enable_changed(void *data, calldata_t *)
+{
+    wake_supervisor((filter_t *)data, SUPERVISE_EVENT_ENABLE);
+}
+
+void parent_updated(void *data, calldata_t *)
+{
+    wake_supervisor((filter_t *)data, SUPERVISE_EVENT_SOURCE);
+}
+
 void *create(obs_data_t *settings, obs_source_t *source)
 {
     obs_log(LOG_DEBUG, "%s: Filter creating", obs_source_get_name(source));
     obs_log(LOG_DEBUG, "filter_settings_json=%s", obs_data_get_json(settings));
 
-    auto filter = (filter_t *)bzalloc(sizeof(filter_t));
-    pthread_mutex_init(&filter->audio_buffer_mutex, NULL);
+    auto filter = new filter_t();
 
     filter->source = source;
 
+    // Preallocate audio buffer for filter's audio (Producer and consumer never allocate).
+    // OBS audio layout is fixed while sources exist, so it's never re-initialized under running producer.
+    // Readers attach at its current write position.
+    auto audio = obs_get_audio();
+    audio_ring_init(
+        &filter->audio_buffer, audio_output_get_channels(audio), MAX_AUDIO_BUFFER_FRAMES,
+        audio_output_get_sample_rate(audio)
+    );
+
     if (!strcmp(obs_data_get_last_json(settings), "{}")) {
         // Maybe initial creation
         load_recently(settings);
     }
 
-    // Fiter activate immediately when "server" is exists.
-    auto server = obs_data_get_string(settings, "server");
-    filter->filter_active = !!strlen(server);
+    // Fiter activate immediately when "server" is exists or recording is enabled.
+    filter->filter_active = outputs_configured(settings);
+    load_supervise_settings(filter, settings);
+
+    // Listen filter's "Eye" icon
+    signal_handler_connect(obs_source_get_signal_handler(source), "enable", filter_enable_changed, filter);
+
+    telemetry_register(filter);
 
     obs_log(LOG_INFO, "%s: Filter created", obs_source_get_name(filter->source));
     return filter;
@@ -376,10 +499,14 @@ void destroy(void *data)
     auto source = filter->source;
     obs_log(LOG_DEBUG, "%s: Filter destroying", obs_source_get_name(source));
 
+    signal_handler_disconnect(obs_source_get_signal_handler(source), "enable", filter_enable_changed, filter);
+    telemetry_unregister(filter);
+
+    // No output job is running (It holds a reference to the source)
+    startup_cancel(filter);
     stop_output(filter);
-    pthread_mutex_destroy(&filter->audio_buffer_mutex);
-    bfree(filter->audio_conv_buffer);
-    bfree(filter);
+    audio_ring_free(&filter->audio_buffer);
+    delete filter;
 
     obs_log(LOG_INFO, "%s: Filter destroyed", obs_source_get_name(source));
 }
@@ -391,140 +518,461 @@ inline void restart_output(filter_t *filter)
     }
 
     auto settings = obs_source_get_settings(filter->source);
-    auto server = obs_data_get_string(settings, "server");
-    if (strlen(server)) {
+    if (outputs_configured(settings)) {
         start_output(filter, settings);
     }
     obs_data_release(settings);
 }
 
-inline bool connect_attempting_timed_out(filter_t *filter)
+inline bool connect_attempting_timed_out(destination_t *dest)
 {
-    return filter->connect_attempting_at &&
-           os_gettime_ns() - filter->connect_attempting_at > CONNECT_ATTEMPTING_TIMEOUT_NS;
+    return dest->connect_attempting_at &&
+           os_gettime_ns() - dest->connect_attempting_at > CONNECT_ATTEMPTING_TIMEOUT_NS;
 }
 
+// Lookup scene graph index only when scene graph has been changed since last check
 inline bool source_available(filter_t *filter, obs_source_t *source)
 {
-    auto now = os_gettime_ns();
-    if (now - filter->last_available_at < AVAILAVILITY_CHECK_INTERVAL_NS) {
-        return true;
+    auto generation = scene_graph_generation();
+    if (filter->scene_generation == generation) {
+        return filter->source_found;
+    }
+    filter->scene_generation = generation;
+
+    filter->source_found = !!obs_scene_from_source(source) || scene_graph_contains(source);
+    return filter->source_found;
+}
+
+// Settings which encoders accept while encoding (Via obs_encoder_update)
+static const char *live_settings[] = {"bitrate", "max_bitrate", "buffer_size", "audio_bitrate"};
+
+// NOTE: Both must have the source defaults, so explicit and default values compare equal.
+inline bool settings_equal(obs_data_t *a, obs_data_t *b)
+{
+    // Filter settings which don't shape the encoder group but need restart
+    return obs_data_get_bool(a, "share_encoders") == obs_data_get_bool(b, "share_encoders") &&
+           obs_data_get_bool(a, "adaptive_bitrate") == obs_data_get_bool(b, "adaptive_bitrate") &&
+           obs_data_get_int(a, "abr_min_bitrate") == obs_data_get_int(b, "abr_min_bitrate") &&
+           obs_data_get_int(a, "locked_width") == obs_data_get_int(b, "locked_width") &&
+           obs_data_get_int(a, "locked_height") == obs_data_get_int(b, "locked_height") &&
+           normalize_encoder_settings(a) == normalize_encoder_settings(b);
+}
+
+inline bool destination_settings_equal(obs_data_t *a, obs_data_t *b, size_t index)
+{
+    auto dest_a = get_destination_settings(a, index);
+    auto dest_b = get_destination_settings(b, index);
+
+    auto equal = !dest_a == !dest_b;
+    if (equal && dest_a) {
+        equal = !strcmp(obs_data_get_string(dest_a, "server"), obs_data_get_string(dest_b, "server")) &&
+                !strcmp(obs_data_get_string(dest_a, "key"), obs_data_get_string(dest_b, "key"));
+    }
+
+    obs_data_release(dest_a);
+    obs_data_release(dest_b);
+    return equal;
+}
+
+// Classify changes between active and current settings, then tear down only what is needed:
+// - Destination changes: Recreate service and output of the destination only
+// - Live settings changes: Update encoders
+// - Others: Full restart
+void apply_settings(filter_t *filter)
+{
+    auto settings_rev = filter->stored_settings_rev;
+    auto settings = obs_source_get_settings(filter->source);
+    auto active_settings = filter->active_settings;
+
+    if (!filter->output_active || !active_settings || !filter->encoders ||
+        !outputs_configured(settings)) {
+        obs_data_release(settings);
+        restart_output(filter);
+        return;
     }
-    filter->last_available_at = now;
 
-    auto found = !!obs_scene_from_source(source);
-    if (found) {
-        return true;
+    // Compare except destinations and live settings
+    auto rest_a = obs_get_source_defaults(obs_source_get_id(filter->source));
+    auto rest_b = obs_get_source_defaults(obs_source_get_id(filter->source));
+    obs_data_apply(rest_a, active_settings);
+    obs_data_apply(rest_b, settings);
+    erase_destination_settings(rest_a);
+    erase_destination_settings(rest_b);
+    erase_recording_settings(rest_a);
+    erase_recording_settings(rest_b);
+    erase_startup_settings(rest_a);
+    erase_startup_settings(rest_b);
+
+    auto live_changed = false;
+    auto live_changes = obs_data_create();
+    for (auto name : live_settings) {
+        auto value = obs_data_get_int(rest_b, name);
+        if (obs_data_get_int(rest_a, name) != value) {
+            live_changed = true;
+            obs_data_set_int(live_changes, name, value);
+        }
+        obs_data_erase(rest_a, name);
+        obs_data_erase(rest_b, name);
     }
 
-    obs_frontend_source_list scenes = {0};
-    obs_frontend_get_scenes(&scenes);
+    auto rebuild = !settings_equal(rest_a, rest_b);
+    obs_data_release(rest_a);
+    obs_data_release(rest_b);
 
-    for (size_t i = 0; i < scenes.sources.num && !found; i++) {
-        obs_scene_t *scene = obs_scene_from_source(scenes.sources.array[i]);
-        found = !!obs_scene_find_source_recursive(scene, obs_source_get_name(source));
+    if (!rebuild && live_changed) {
+        if (encoder_group_update(filter->encoders, filter, settings, live_changes)) {
+            // Adaptive bitrate restarts from new bitrate
+            reset_adaptive_bitrate(filter, settings);
+        } else {
+            // Shared encoders can't follow one filter's settings, or encoders can't change bitrate while encoding
+            rebuild = true;
+        }
     }
+    obs_data_release(live_changes);
 
-    obs_frontend_source_list_free(&scenes);
+    if (rebuild) {
+        obs_log(LOG_INFO, "%s: Attempting restart with new settings", obs_source_get_name(filter->source));
+        obs_data_release(settings);
+        restart_output(filter);
+        return;
+    }
 
-    return found;
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        if (!destination_settings_equal(active_settings, settings, i)) {
+            obs_log(
+                LOG_INFO, "%s: Attempting restart the stream output #%zu with new destination",
+                obs_source_get_name(filter->source), i + 1
+            );
+            restart_destination(filter, i);
+        }
+    }
+
+    if (!recording_settings_equal(active_settings, settings)) {
+        obs_log(
+            LOG_INFO, "%s: Attempting restart the recording with new settings", obs_source_get_name(filter->source)
+        );
+        restart_recording(filter);
+    }
+
+    filter->active_settings_rev = settings_rev;
+    obs_data_clear(filter->active_settings);
+    obs_data_apply(filter->active_settings, settings);
+    obs_data_release(settings);
 }
 
-// NOTE: Becareful this function is called so offen.
-void video_tick(void *data, float)
+// Runs on worker thread. Filter's outputs are owned by the job until output_busy is cleared.
+// The job holds a reference to the filter source, so the filter outlives the job.
+void output_job(void *data)
 {
     auto filter = (filter_t *)data;
-    // Block output initiation until filter is active.
-    if (!filter->filter_active) {
+    auto intents = filter->output_intents;
+
+    if (intents & OUTPUT_INTENT_STOP) {
+        stop_output(filter);
+    }
+
+    if (intents & OUTPUT_INTENT_RESTART) {
+        restart_output(filter);
+    }
+
+    if (intents & OUTPUT_INTENT_APPLY) {
+        apply_settings(filter);
+    }
+
+    if (intents & OUTPUT_INTENT_RECORDING) {
+        restart_recording(filter);
+    }
+
+    if (intents & OUTPUT_INTENT_STANDBY) {
+        standby_output(filter);
+    }
+
+    if (filter->startup_slot) {
+        filter->startup_slot = false;
+        startup_slot_release();
+    }
+
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        if (intents & OUTPUT_INTENT_RECONNECT(i)) {
+            restart_destination(filter, i);
+            reconnect_slot_release();
+        }
+    }
+
+    filter->output_intents = 0;
+    filter->output_busy.store(false, std::memory_order_release);
+
+    // Reference taken by post_output_job() (destroy() may run here)
+    obs_source_release(filter->source);
+}
+
+// NOTE: Must be called from video_tick() only while output_busy is false.
+inline void post_output_job(filter_t *filter, uint32_t intents)
+{
+    // The job holds the source, so destroy() never runs while the job owns outputs
+    if (!obs_source_get_ref(filter->source)) {
+        // Source is being destroyed -> Give back slots taken for the job
+        if (filter->startup_slot) {
+            filter->startup_slot = false;
+            startup_slot_release();
+        }
+        for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+            if (intents & OUTPUT_INTENT_RECONNECT(i)) {
+                reconnect_slot_release();
+            }
+        }
         return;
     }
 
+    filter->output_intents = intents;
+    filter->output_busy.store(true, std::memory_order_release);
+    worker_pool_post(output_job, filter);
+}
+
+// Called by video_tick() when some events arrived or periodically (SUPERVISE_INTERVAL_NS)
+// Blocking operations are posted to worker pool.
+void supervise(filter_t *filter)
+{
     auto source_enabled = obs_source_enabled(filter->source);
 
     if (filter->output_active) {
-        auto stream_active = obs_output_active(filter->stream_output);
+        auto stream_active = false;
+        auto connecting = false;
+        uint32_t reconnects = 0;
+
+        for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+            auto dest = &filter->destinations[i];
+            if (!dest->stream_output) {
+                continue;
+            }
+
+            if (obs_output_active(dest->stream_output)) {
+                stream_active = true;
+            }
+
+            if (!source_enabled) {
+                continue;
+            }
+
+            if (!connect_attempting_timed_out(dest)) {
+                connecting = true;
+                continue;
+            }
+
+            if (obs_output_active(dest->stream_output)) {
+                if (!obs_output_reconnecting(dest->stream_output)) {
+                    // Connection is stable
+                    dest->reconnect_attempts = 0;
+                }
+                continue;
+            }
+
+            connecting = true;
+
+            if (!dest->reconnect_at) {
+                // Schedule reconnection with backoff
+                auto delay = reconnect_backoff_ns(dest->reconnect_attempts);
+                dest->reconnect_at = os_gettime_ns() + delay;
+                obs_log(
+                    LOG_INFO, "%s: Reconnect the stream output #%zu in %llu ms", obs_source_get_name(filter->source),
+                    i + 1, (unsigned long long)(delay / 1000000)
+                );
+                continue;
+            }
+
+            if (os_gettime_ns() >= dest->reconnect_at && reconnect_slot_try_acquire()) {
+                // Retry connection (Only this destination, encoders are kept)
+                obs_log(
+                    LOG_INFO, "%s: Attempting reactivate the stream output #%zu (Attempt %u)",
+                    obs_source_get_name(filter->source), i + 1, dest->reconnect_attempts + 1
+                );
+                dest->reconnect_attempts++;
+                dest->reconnect_at = 0;
+                reconnects |= OUTPUT_INTENT_RECONNECT(i);
+            }
+        }
+
+        // Recording stopped by itself (e.g. Disk full or I/O error)
+        auto rec = &filter->recording;
+        if (rec->output && obs_output_active(rec->output)) {
+            stream_active = true;
+            if (os_gettime_ns() - rec->started_at > CONNECT_ATTEMPTING_TIMEOUT_NS) {
+                // Recording is stable
+                rec->restart_attempts = 0;
+            }
+
+            // Muxer pipe is full when nothing is written for a while (Disk stalled)
+            auto now = os_gettime_ns();
+            auto bytes = obs_output_get_total_bytes(rec->output);
+            if (bytes != rec->written_bytes) {
+                if (rec->stalled) {
+                    obs_log(LOG_INFO, "%s: Recording resumed writing", obs_source_get_name(filter->source));
+                    rec->stalled = false;
+                }
+                rec->written_bytes = bytes;
+                rec->written_at = now;
+            } else if (!rec->stalled && now - rec->written_at > RECORDING_STALL_TIMEOUT_NS) {
+                obs_log(
+                    LOG_WARNING, "%s: Recording hasn't written for %llu ms, disk may be stalled (Encoders are blocked)",
+                    obs_source_get_name(filter->source), (unsigned long long)((now - rec->written_at) / 1000000)
+                );
+                rec->stalled = true;
+            }
+        } else if (rec->active && source_enabled) {
+            if (!rec->restart_at) {
+                auto delay = reconnect_backoff_ns(rec->restart_attempts);
+                rec->restart_at = os_gettime_ns() + delay;
+                auto error = obs_output_get_last_error(rec->output);
+                obs_log(
+                    LOG_WARNING, "%s: Recording stopped (%s), restart in %llu ms", obs_source_get_name(filter->source),
+                    error ? error : "Unknown error", (unsigned long long)(delay / 1000000)
+                );
+            } else if (os_gettime_ns() >= rec->restart_at) {
+                rec->restart_attempts++;
+                rec->restart_at = 0;
+                reconnects |= OUTPUT_INTENT_RECORDING;
+            }
+        }
+
+        if (reconnects) {
+            post_output_job(filter, reconnects);
+            return;
+        }
 
         if (source_enabled) {
-            if (connect_attempting_timed_out(filter)) {
-                if (!stream_active) {
-                    // Retry connection
-                    obs_log(
-                        LOG_INFO, "%s: Attempting reactivate the stream output", obs_source_get_name(filter->source)
-                    );
-                    auto settings = obs_source_get_settings(filter->source);
-                    start_output(filter, settings);
-                    obs_data_release(settings);
+            if (connecting) {
+                // It's unwelcome to do stopping output during attempting connect to service.
+                return;
+            }
+
+            if (filter->active_settings_rev < filter->stored_settings_rev) {
+                // Settings has been changed
+                obs_log(LOG_INFO, "%s: Settings change detected", obs_source_get_name(filter->source));
+                post_output_job(filter, OUTPUT_INTENT_APPLY);
+                return;
+            }
+
+            if (stream_active && filter->resolution_locked) {
+                // Source size never affects locked resolution
+                auto parent = obs_filter_get_parent(filter->source);
+                if (!source_available(filter, parent)) {
+                    // Stop output when source had been removed
+                    post_output_job(filter, OUTPUT_INTENT_STOP);
                     return;
                 }
 
-                if (filter->active_settings_rev < filter->stored_settings_rev) {
-                    // Settings has been changed
-                    obs_log(
-                        LOG_INFO, "%s: Settings change detected, Attempting restart",
-                        obs_source_get_name(filter->source)
-                    );
-                    restart_output(filter);
+            } else if (stream_active) {
+                // Monitoring source
+                auto parent = obs_filter_get_parent(filter->source);
+                auto width = obs_source_get_width(parent);
+                width += (width & 1);
+                uint32_t height = obs_source_get_height(parent);
+                height += (height & 1);
+
+                if (!width || !height || !source_available(filter, parent)) {
+                    // Stop output when source resolution is zero or source had been removed
+                    post_output_job(filter, OUTPUT_INTENT_STOP);
                     return;
                 }
 
-                if (stream_active) {
-                    // Monitoring source
-                    auto parent = obs_filter_get_parent(filter->source);
-                    auto width = obs_source_get_width(parent);
-                    width += (width & 1);
-                    uint32_t height = obs_source_get_height(parent);
-                    height += (height & 1);
-
-                    if (!width || !height || !source_available(filter, parent)) {
-                        // Stop output when source resolution is zero or source had been removed
-                        stop_output(filter);
-                        return;
-                    }
-
-                    if (filter->width != width || filter->height != height) {
-                        // Restart output when source resolution was changed.
-                        obs_log(
-                            LOG_INFO, "%s: Attempting restart the stream output", obs_source_get_name(filter->source)
-                        );
-                        auto settings = obs_source_get_settings(filter->source);
-                        start_output(filter, settings);
-                        obs_data_release(settings);
-                        return;
-                    }
+                if (filter->width != width || filter->height != height) {
+                    // Restart output when source resolution was changed.
+                    obs_log(LOG_INFO, "%s: Attempting restart the stream output", obs_source_get_name(filter->source));
+                    post_output_job(filter, OUTPUT_INTENT_RESTART);
+                    return;
                 }
             }
 
         } else {
             if (stream_active) {
                 // Clicked filter's "Eye" icon (Hide)
-                stop_output(filter);
+                post_output_job(filter, filter->warm_standby ? OUTPUT_INTENT_STANDBY : OUTPUT_INTENT_STOP);
                 return;
             }
         }
 
     } else {
+        uint32_t intents = 0;
         if (source_enabled) {
             // Clicked filter's "Eye" icon (Show)
-            restart_output(filter);
+            intents = OUTPUT_INTENT_RESTART;
+        } else if (filter->warm_standby &&
+                   (!filter->standby || filter->standby_settings_rev < filter->stored_settings_rev)) {
+            // Prepare (Or rebuild) view and encoders while hidden
+            intents = OUTPUT_INTENT_STANDBY;
+        } else if (!filter->warm_standby && filter->standby) {
+            // Warm standby has been turned off
+            post_output_job(filter, OUTPUT_INTENT_STOP);
             return;
         }
+
+        if (!intents) {
+            startup_cancel(filter);
+            return;
+        }
+
+        // Starting from warm standby is light, the others are staggered with other filters
+        if (!(filter->standby && (intents & OUTPUT_INTENT_RESTART))) {
+            if (!startup_slot_try_acquire(filter, filter->startup_priority)) {
+                filter->next_supervise_at = os_gettime_ns() + STARTUP_RETRY_INTERVAL_NS;
+                return;
+            }
+            filter->startup_slot = true;
+        }
+
+        post_output_job(filter, intents);
+    }
+}
+
+// NOTE: Becareful this function is called so offen.
+void video_tick(void *data, float)
+{
+    auto filter = (filter_t *)data;
+    // Block output initiation until filter is active.
+    if (!filter->filter_active) {
+        return;
+    }
+
+    // Outputs are being started or stopped on worker thread (Events are kept until the job finishes)
+    if (filter->output_busy.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Nothing to do until events arrive or interval elapses
+    auto now = os_gettime_ns();
+    if (!filter->supervise_events.load(std::memory_order_relaxed) && now < filter->next_supervise_at) {
+        return;
+    }
+    auto events = filter->supervise_events.exchange(0, std::memory_order_acquire);
+    filter->next_supervise_at = now + SUPERVISE_INTERVAL_NS;
+
+    if (events & SUPERVISE_EVENT_TRACE) {
+        telemetry_dump_trace(filter);
     }
+
+    telemetry_sample(filter);
+    supervise(filter);
 }
 
 BranchOutputStatus *status_dock = nullptr;
 
-void filter_add(void *data, obs_source_t *)
+void filter_add(void *data, obs_source_t *parent)
 {
     // Register to output status dock
     auto filter = (filter_t *)data;
     status_dock->AddFilter(filter);
+
+    // Listen parent source (Resolution may be changed)
+    signal_handler_connect(obs_source_get_signal_handler(parent), "update", parent_updated, filter);
 }
 
-void filter_remove(void *data, obs_source_t *)
+void filter_remove(void *data, obs_source_t *parent)
 {
     // Unregister from output status dock
     auto filter = (filter_t *)data;
     status_dock->RemoveFilter(filter);
+
+    signal_handler_disconnect(obs_source_get_signal_handler(parent), "update", parent_updated, filter);
 }
 
 const char *get_name(void *)
@@ -560,6 +1008,14 @@ obs_source_info filter_info;
 
 bool obs_module_load()
 {
+    auto mix_isa = audio_mix_init();
+    obs_log(LOG_DEBUG, "Audio mix kernel: %s", mix_isa);
+
+    scene_graph_watch_init();
+    properties_cache_init();
+    worker_pool_init(OUTPUT_WORKER_THREADS);
+    recently_store_init(SETTINGS_JSON_NAME);
+
     filter_info = create_filter_info();
     obs_register_source(&filter_info);
 
@@ -570,9 +1026,21 @@ bool obs_module_load()
 void obs_module_post_load()
 {
     status_dock = create_output_status_dock();
+    telemetry_start_metrics_server();
+    telemetry_load_tracing();
+
+    // Encoders of all modules are registered at this point
+    encoder_pool_load();
 }
 
 void obs_module_unload()
 {
+    telemetry_stop_metrics_server();
+    worker_pool_free();
+    recently_store_free();
+    encoder_pool_clear();
+    properties_cache_free();
+    scene_graph_watch_free();
+    audio_arena_free();
     obs_log(LOG_INFO, "Plugin unloaded");
 }
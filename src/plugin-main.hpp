@@ -19,10 +19,20 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 //#define NO_AUDIO
+//#define BENCHMARK_AUDIO
 
 #include <obs-module.h>
-#include <util/deque.h>
 #include <util/threading.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "audio/audio-ring.hpp"
+#include "audio/audio-hub.hpp"
+#include "audio/audio-drift.hpp"
+#include "audio/audio-bus.hpp"
+#include "video/view-cache.hpp"
+#include "telemetry/telemetry.hpp"
+#include "supervisor/bitrate-control.hpp"
 #include "dock/output-status.hpp"
 
 #define FILTER_ID "osi_branch_output"
@@ -31,7 +41,10 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #define OUTPUT_MAX_RETRIES 7
 #define OUTPUT_RETRY_DELAY_SECS 1
 #define CONNECT_ATTEMPTING_TIMEOUT_NS 15000000000ULL
-#define AVAILAVILITY_CHECK_INTERVAL_NS 1000000000ULL
+#define SUPERVISE_INTERVAL_NS 1000000000ULL
+#define RECORDING_STALL_TIMEOUT_NS 10000000000ULL
+#define OUTPUT_WORKER_THREADS 4
+#define MAX_STREAM_DESTINATIONS 4 // Including primary "server" and "key"
 
 enum AudioSourceType {
     AUDIO_SOURCE_TYPE_SILENCE,
@@ -40,62 +53,186 @@ enum AudioSourceType {
     AUDIO_SOURCE_TYPE_CAPTURE,
 };
 
+// Events which wake up supervisor in video_tick (Set from signal handlers)
+#define SUPERVISE_EVENT_ENABLE 0x01   // Filter enabled/disabled
+#define SUPERVISE_EVENT_SETTINGS 0x02 // Filter settings updated
+#define SUPERVISE_EVENT_OUTPUT 0x04   // Stream or recording output started/stopped/reconnecting
+#define SUPERVISE_EVENT_SOURCE 0x08   // Parent source updated
+#define SUPERVISE_EVENT_TRACE 0x10    // Latency trace dump requested
+
+// Intents which are executed by output job on worker thread
+#define OUTPUT_INTENT_STOP 0x01
+#define OUTPUT_INTENT_RESTART 0x02                         // Stop and start with current settings
+#define OUTPUT_INTENT_APPLY 0x04                           // Apply changed settings with minimum restart
+#define OUTPUT_INTENT_RECORDING 0x08                       // Restart recording only
+#define OUTPUT_INTENT_STANDBY 0x10                         // Stop outputs but keep view and encoders ready
+#define OUTPUT_INTENT_RECONNECT(index) (0x100 << (index)) // Restart one destination only
+
+struct filter_t;
+struct encoder_placement_t;
+struct frame_divider_t;
+
+// View, audio output and encoder pair which are shared by filters with identical encoder settings.
+// Each filter attaches own stream output to them (See plugin-encoder.cpp)
+struct encoder_group_t {
+    std::string key;
+    std::string name; // Name of the filter which created this group
+    long refs;        // Protected by groups mutex
+
+    // Video context
+    view_cache_t *view; // Shared with other groups on the same parent source
+    video_t *video_output;
+    frame_divider_t *frame_divider; // Frame skipping before libobs 30.2 (Frame rate divisor only)
+    uint32_t width; // Source size
+    uint32_t height;
+    uint32_t output_width; // Scaled size
+    uint32_t output_height;
+
+    // Audio context
+    AudioSourceType audio_source_type;
+    audio_hub_t *audio_hub;               // Shared capture of custom audio source or master track
+    std::vector<filter_t *> audio_feeders; // Members which provide filter's audio
+    pthread_mutex_t audio_reader_mutex;   // Guards reader re-attachment (Consumer never waits for it)
+    audio_ring_reader_t audio_reader;     // Consumer: audio_input_callback or audio_bus_track_callback
+    audio_drift_t audio_drift;            // Consumer: audio_input_callback or audio_bus_track_callback
+    telemetry_audio_t audio_stats;        // Consumer side counters
+#ifdef BENCHMARK_AUDIO
+    uint64_t bench_report_at; // Consumer: audio_input_callback
+#endif
+    speaker_layout audio_channels;
+    uint32_t samples_per_sec;
+    audio_t *audio_output;  // Own output or shared bus's output
+    audio_bus_t *audio_bus; // Shared audio bus (Optional)
+    size_t audio_track;     // Track on the bus (Always 0 on own output)
+
+    obs_encoder_t *video_encoder;
+    obs_encoder_t *audio_encoder;
+    encoder_placement_t *encoder_placement; // Placed by encoder pool ("Auto" encoder only)
+
+    // Latency tracing (Writers: Video and audio threads of the group)
+    latency_trace_t latency_trace;
+    bool trace_video_connected;
+};
+
+// Stream destination fed from filter's encoders
+struct destination_t {
+    obs_output_t *stream_output;
+    obs_service_t *service;
+    bool active;
+
+    // Stream context
+    uint64_t connect_attempting_at;
+    uint32_t reconnect_attempts; // Reset when connection got stable
+    uint64_t reconnect_at;       // Scheduled by reconnect_backoff_ns()
+};
+
+// Local recording fed from filter's encoders (See plugin-recording.cpp)
+struct recording_t {
+    obs_output_t *output;
+    bool active;
+    uint64_t started_at;
+    uint32_t restart_attempts; // Reset when recording got stable
+    uint64_t restart_at;       // Scheduled by reconnect_backoff_ns()
+
+    // Stall detection (Muxer pipe writes block the shared encoders, see create_recording())
+    uint64_t written_bytes;
+    uint64_t written_at;
+    bool stalled;
+};
+
 struct filter_t {
     bool filter_active; // Activate after first "Apply" click
     bool output_active;
     uint32_t stored_settings_rev;
     uint32_t active_settings_rev;
-    uint64_t last_available_at;
+    obs_data_t *active_settings; // Snapshot of the settings which outputs were started with
+
+    // Supervisor context
+    std::atomic<uint32_t> supervise_events; // SUPERVISE_EVENT_* flags
+    uint64_t next_supervise_at;
+    uint64_t scene_generation; // Generation of scene graph when source availability was checked
+    bool source_found;
+    long long startup_priority; // Higher starts first (See supervisor/startup.hpp)
+    bool startup_slot;          // Startup slot is held by output job
+    bool warm_standby;          // Keep view and encoders while hidden
+
+    // Warm standby context (Encoders are kept without outputs)
+    bool standby;
+    uint32_t standby_settings_rev;
+
+    // Output job context
+    std::atomic<bool> output_busy; // Set while output job is posted or running
+    uint32_t output_intents;       // OUTPUT_INTENT_* flags (Accessed by the job owner only)
 
     // Filter source
     obs_source_t *source;
-    obs_weak_source_t *audio_source; // NULL means using filter's audio
 
-    // User choosed encoder
-    obs_encoder_t *video_encoder;
-    obs_encoder_t *audio_encoder;
+    // User choosed encoders (Maybe shared with other filters)
+    encoder_group_t *encoders;
 
-    obs_view_t *view;
-    video_t *video_output;
-    audio_t *audio_output;
-    obs_output_t *stream_output;
-    obs_service_t *service;
+    // Index 0 is primary destination
+    destination_t destinations[MAX_STREAM_DESTINATIONS];
+
+    // Alongside or instead of streaming
+    recording_t recording;
+
+    // Adaptive bitrate context (Supervisor only)
+    bool adaptive_bitrate;
+    bitrate_control_t bitrate_control;
 
     // Video context
     uint32_t width;
     uint32_t height;
+    bool resolution_locked;
 
     // Audio context
-    AudioSourceType audio_source_type;
-    deque audio_buffer;
-    size_t audio_buffer_frames;
-    pthread_mutex_t audio_buffer_mutex;
-    uint8_t *audio_conv_buffer;
-    size_t audio_conv_buffer_size;
-    size_t audio_mix_idx;
-    speaker_layout audio_channels;
-    uint32_t samples_per_sec;
-    uint64_t audio_skip;
-
-    // Stream context
-    uint64_t connect_attempting_at;
-};
-
-struct audio_buffer_chunk_header_t {
-    size_t data_idx[MAX_AUDIO_CHANNELS]; // Zero means unused channel
-    uint32_t frames;
-    uint64_t timestamp;
-    size_t offset;
-    size_t channels;
+    std::atomic<AudioSourceType> audio_source_type; // Gate of audio_filter_callback
+    audio_ring_t audio_buffer; // Producer: audio_filter_callback (Filter's audio only, initialized once by create())
+    telemetry_audio_t audio_stats; // Producer side counters (frames_pushed only)
+
+    // Telemetry context
+    telemetry_ring_t telemetry; // Writer: Supervisor
+    uint64_t next_telemetry_at;
+    uint64_t latency_last[LATENCY_STAGE_COUNT][LATENCY_TRACE_BUCKETS]; // Supervisor only
 };
 
 void update(void *data, obs_data_t *settings);
 void get_defaults(obs_data_t *defaults);
 obs_properties_t *get_properties(void *data);
-void audio_capture_callback(void *param, obs_source_t *, const audio_data *audio_data, bool muted);
-void master_audio_callback(void *param, size_t, audio_data *audio_data);
 obs_audio_data *audio_filter_callback(void *param, obs_audio_data *audio_data);
 bool audio_input_callback(
     void *param, uint64_t start_ts_in, uint64_t, uint64_t *out_ts, uint32_t mixers, audio_output_data *mixes
 );
+bool audio_bus_track_callback(
+    void *param, uint64_t start_ts_in, uint64_t, uint64_t *out_ts, uint32_t mixers, audio_output_data *mixes
+);
 BranchOutputStatus *create_output_status_dock();
+encoder_group_t *encoder_group_acquire(filter_t *filter, obs_data_t *settings, uint32_t width, uint32_t height);
+void encoder_group_release(encoder_group_t *group, filter_t *filter);
+bool encoder_group_update(encoder_group_t *group, filter_t *filter, obs_data_t *settings, obs_data_t *changes);
+bool encoder_group_matches(
+    encoder_group_t *group, filter_t *filter, obs_data_t *settings, uint32_t width, uint32_t height
+);
+std::string normalize_encoder_settings(obs_data_t *settings);
+void erase_destination_settings(obs_data_t *settings);
+void erase_startup_settings(obs_data_t *settings);
+void connect_output_signals(filter_t *filter, obs_output_t *output, bool connect);
+void add_recording_formats(obs_property_t *prop);
+bool recording_enabled(obs_data_t *settings);
+void erase_recording_settings(obs_data_t *settings);
+bool recording_settings_equal(obs_data_t *a, obs_data_t *b);
+bool create_recording(filter_t *filter, obs_data_t *settings);
+bool start_recording(filter_t *filter);
+void stop_recording(filter_t *filter);
+void restart_recording(filter_t *filter);
+void telemetry_sample(filter_t *filter);
+void telemetry_register(filter_t *filter);
+void telemetry_unregister(filter_t *filter);
+void telemetry_start_metrics_server();
+void telemetry_stop_metrics_server();
+void telemetry_log_summary(filter_t *filter);
+void telemetry_load_tracing();
+void telemetry_dump_trace(filter_t *filter);
+void encoder_pool_load();
+void reset_adaptive_bitrate(filter_t *filter, obs_data_t *settings);
+void adapt_bitrate(filter_t *filter, telemetry_sample_t *sample);
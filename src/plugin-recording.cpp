@@ -0,0 +1,201 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <util/dstr.h>
+#include "plugin-main.hpp"
+
+#define RECORDING_FILENAME_FORMAT "%CCYY-%MM-%DD %hh-%mm-%ss"
+
+struct recording_format_t {
+    const char *id;
+    const char *extension;
+    const char *muxer_settings;
+};
+
+// Hybrid MP4 requires newer libobs, so fragmented MP4 is offered as crash-safe MP4
+static const recording_format_t recording_formats[] = {
+    {"mkv", "mkv", ""},
+    {"fragmented_mp4", "mp4", "movflags=frag_keyframe+empty_moov+delay_moov"},
+    {"mp4", "mp4", ""},
+    {"mov", "mov", ""},
+    {"mpegts", "ts", ""},
+};
+
+inline const recording_format_t *find_recording_format(const char *id)
+{
+    for (auto &format : recording_formats) {
+        if (!strcmp(format.id, id)) {
+            return &format;
+        }
+    }
+    return &recording_formats[0];
+}
+
+void add_recording_formats(obs_property_t *prop)
+{
+    char title[64];
+    for (auto &format : recording_formats) {
+        snprintf(title, sizeof(title), "RecordingFormat.%s", format.id);
+        obs_property_list_add_string(prop, obs_module_text(title), format.id);
+    }
+}
+
+// Settings which affect recording only (Changing them never restarts streaming)
+static const char *recording_settings[] = {
+    "recording", "rec_path", "rec_format", "rec_split_file", "rec_split_size_mb", "rec_split_time_min",
+};
+
+bool recording_enabled(obs_data_t *settings)
+{
+    return obs_data_get_bool(settings, "recording") && strlen(obs_data_get_string(settings, "rec_path"));
+}
+
+void erase_recording_settings(obs_data_t *settings)
+{
+    for (auto name : recording_settings) {
+        obs_data_erase(settings, name);
+    }
+}
+
+bool recording_settings_equal(obs_data_t *a, obs_data_t *b)
+{
+    auto enabled = recording_enabled(a);
+    if (enabled != recording_enabled(b)) {
+        return false;
+    }
+    if (!enabled) {
+        return true;
+    }
+
+    auto split = obs_data_get_bool(a, "rec_split_file");
+    return !strcmp(obs_data_get_string(a, "rec_path"), obs_data_get_string(b, "rec_path")) &&
+           !strcmp(obs_data_get_string(a, "rec_format"), obs_data_get_string(b, "rec_format")) &&
+           split == obs_data_get_bool(b, "rec_split_file") &&
+           (!split || (obs_data_get_int(a, "rec_split_size_mb") == obs_data_get_int(b, "rec_split_size_mb") &&
+                       obs_data_get_int(a, "rec_split_time_min") == obs_data_get_int(b, "rec_split_time_min")));
+}
+
+// Create muxer output for recording (Encoders are attached later)
+// Files are written by obs-ffmpeg-mux process, so disk stalls don't block the encoders' threads
+// until its pipe fills up. After that, ffmpeg_muxer's packet writes block inside libobs and the shared encoders
+// (So streams too) stall with it. It can't be buffered here because libobs has no API to feed packets into other
+// output, so the supervisor only reports it (See RECORDING_STALL_TIMEOUT_NS).
+bool create_recording(filter_t *filter, obs_data_t *settings)
+{
+    auto rec = &filter->recording;
+    auto directory = obs_data_get_string(settings, "rec_path");
+    auto format = find_recording_format(obs_data_get_string(settings, "rec_format"));
+
+    auto filename = os_generate_formatted_filename(format->extension, true, RECORDING_FILENAME_FORMAT);
+    struct dstr path = {0};
+    dstr_copy(&path, directory);
+    dstr_replace(&path, "\\", "/");
+    if (dstr_end(&path) != '/') {
+        dstr_cat_ch(&path, '/');
+    }
+    dstr_cat(&path, filename);
+    bfree(filename);
+
+    auto rec_settings = obs_data_create();
+    obs_data_set_string(rec_settings, "path", path.array);
+    obs_data_set_string(rec_settings, "muxer_settings", format->muxer_settings);
+
+    // Split files are named by the muxer with same format
+    auto split = obs_data_get_bool(settings, "rec_split_file");
+    obs_data_set_bool(rec_settings, "split_file", split);
+    obs_data_set_string(rec_settings, "directory", directory);
+    obs_data_set_string(rec_settings, "format", RECORDING_FILENAME_FORMAT);
+    obs_data_set_string(rec_settings, "extension", format->extension);
+    obs_data_set_bool(rec_settings, "allow_spaces", true);
+    obs_data_set_bool(rec_settings, "allow_overwrite", false);
+    obs_data_set_int(rec_settings, "max_size_mb", split ? obs_data_get_int(settings, "rec_split_size_mb") : 0);
+    obs_data_set_int(rec_settings, "max_time_sec", split ? obs_data_get_int(settings, "rec_split_time_min") * 60 : 0);
+
+    rec->output = obs_output_create("ffmpeg_muxer", obs_source_get_name(filter->source), rec_settings, NULL);
+    obs_data_release(rec_settings);
+
+    if (!rec->output) {
+        obs_log(LOG_ERROR, "%s: Recording output creation failed", obs_source_get_name(filter->source));
+        dstr_free(&path);
+        return false;
+    }
+    connect_output_signals(filter, rec->output, true);
+
+    obs_log(LOG_INFO, "%s: Recording to %s", obs_source_get_name(filter->source), path.array);
+    dstr_free(&path);
+    return true;
+}
+
+// Attach recording output to filter's encoders and start it
+bool start_recording(filter_t *filter)
+{
+    auto rec = &filter->recording;
+
+    obs_output_set_video_encoder(rec->output, filter->encoders->video_encoder);
+    obs_output_set_audio_encoder(rec->output, filter->encoders->audio_encoder, 0);
+
+    if (obs_output_start(rec->output)) {
+        rec->active = true;
+        rec->started_at = os_gettime_ns();
+        rec->written_bytes = 0;
+        rec->written_at = rec->started_at;
+        rec->stalled = false;
+        obs_log(LOG_INFO, "%s: Starting recording output succeeded", obs_source_get_name(filter->source));
+    } else {
+        obs_log(LOG_ERROR, "%s: Starting recording output failed", obs_source_get_name(filter->source));
+    }
+
+    return rec->active;
+}
+
+void stop_recording(filter_t *filter)
+{
+    auto rec = &filter->recording;
+
+    if (rec->output) {
+        // Intentional stopping doesn't need supervision
+        connect_output_signals(filter, rec->output, false);
+
+        if (rec->active) {
+            obs_output_stop(rec->output);
+        }
+
+        obs_output_release(rec->output);
+        rec->output = NULL;
+    }
+
+    if (rec->active) {
+        rec->active = false;
+        obs_log(LOG_INFO, "%s: Stopping recording output succeeded", obs_source_get_name(filter->source));
+    }
+}
+
+// Restart recording only (Streaming keeps running). A new file is started.
+void restart_recording(filter_t *filter)
+{
+    stop_recording(filter);
+
+    auto settings = obs_source_get_settings(filter->source);
+    if (filter->encoders && recording_enabled(settings) && create_recording(filter, settings)) {
+        start_recording(filter);
+    }
+    obs_data_release(settings);
+}
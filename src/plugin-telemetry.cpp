@@ -0,0 +1,296 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <string>
+#include "plugin-main.hpp"
+#include "telemetry/metrics-server.hpp"
+
+static_assert(TELEMETRY_MAX_DESTINATIONS >= MAX_STREAM_DESTINATIONS, "Telemetry can't hold all destinations");
+
+// NOTE: Called by supervisor only while no output job is running (Outputs and encoders are stable).
+void telemetry_sample(filter_t *filter)
+{
+    auto now = os_gettime_ns();
+    if (now < filter->next_telemetry_at) {
+        return;
+    }
+    filter->next_telemetry_at = now + TELEMETRY_SAMPLE_INTERVAL_NS;
+
+    telemetry_sample_t sample = {0};
+    sample.timestamp = now;
+    sample.audio_frames_pushed = filter->audio_stats.frames_pushed.load(std::memory_order_relaxed);
+
+    // Encoder group's counters are shared by its members
+    auto group = filter->encoders;
+    if (group) {
+        sample.audio_frames_popped = group->audio_stats.frames_popped.load(std::memory_order_relaxed);
+        sample.audio_overruns = group->audio_stats.overruns.load(std::memory_order_relaxed);
+        sample.audio_underruns = group->audio_stats.underruns.load(std::memory_order_relaxed);
+        sample.audio_buffer_depth = group->audio_stats.buffer_depth.load(std::memory_order_relaxed);
+        sample.video_frames_total = video_output_get_total_frames(group->video_output);
+        sample.video_frames_skipped = video_output_get_skipped_frames(group->video_output);
+
+        // Samples since last telemetry sample of this filter
+        for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+            sample.latency[stage] =
+                latency_trace_summarize(&group->latency_trace, (LatencyStage)stage, filter->latency_last[stage]);
+        }
+    }
+
+    for (size_t i = 0; i < MAX_STREAM_DESTINATIONS; i++) {
+        auto output = filter->destinations[i].stream_output;
+        if (!output) {
+            continue;
+        }
+
+        auto dest = &sample.destinations[i];
+        dest->configured = true;
+        dest->active = obs_output_active(output);
+        dest->reconnecting = obs_output_reconnecting(output);
+        dest->bytes_sent = obs_output_get_total_bytes(output);
+        dest->total_frames = obs_output_get_total_frames(output);
+        dest->frames_dropped = obs_output_get_frames_dropped(output);
+
+        sample.bytes_sent += dest->bytes_sent;
+        sample.frames_dropped += dest->frames_dropped;
+        sample.active_destinations += dest->active;
+        sample.reconnecting_destinations += dest->reconnecting;
+
+        auto congestion = obs_output_get_congestion(output);
+        if (congestion > sample.congestion) {
+            sample.congestion = congestion;
+        }
+    }
+
+    // Decision is recorded in this sample
+    adapt_bitrate(filter, &sample);
+
+    auto rec_output = filter->recording.output;
+    if (rec_output) {
+        sample.recording.configured = true;
+        sample.recording.active = obs_output_active(rec_output);
+        sample.recording.bytes_sent = obs_output_get_total_bytes(rec_output);
+        sample.recording.total_frames = obs_output_get_total_frames(rec_output);
+        sample.recording.frames_dropped = obs_output_get_frames_dropped(rec_output);
+    }
+
+    telemetry_ring_push(&filter->telemetry, &sample);
+}
+
+inline obs_data_t *create_sample_data(const telemetry_sample_t *sample)
+{
+    auto data = obs_data_create();
+    obs_data_set_int(data, "timestamp", (long long)sample->timestamp);
+    obs_data_set_int(data, "audio_frames_pushed", (long long)sample->audio_frames_pushed);
+    obs_data_set_int(data, "audio_frames_popped", (long long)sample->audio_frames_popped);
+    obs_data_set_int(data, "audio_overruns", (long long)sample->audio_overruns);
+    obs_data_set_int(data, "audio_underruns", (long long)sample->audio_underruns);
+    obs_data_set_int(data, "audio_buffer_depth", (long long)sample->audio_buffer_depth);
+    obs_data_set_int(data, "video_frames_total", sample->video_frames_total);
+    obs_data_set_int(data, "video_frames_skipped", sample->video_frames_skipped);
+    obs_data_set_int(data, "bytes_sent", (long long)sample->bytes_sent);
+    obs_data_set_int(data, "frames_dropped", sample->frames_dropped);
+    obs_data_set_double(data, "congestion", sample->congestion);
+    obs_data_set_int(data, "active_destinations", sample->active_destinations);
+    obs_data_set_int(data, "reconnecting_destinations", sample->reconnecting_destinations);
+    obs_data_set_int(data, "video_bitrate", sample->video_bitrate);
+    obs_data_set_int(data, "bitrate_decision", sample->bitrate_decision);
+
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        auto prefix = std::string("latency_") + latency_stage_name((LatencyStage)stage);
+        auto latency = &sample->latency[stage];
+        obs_data_set_int(data, (prefix + "_samples").c_str(), (long long)latency->samples);
+        obs_data_set_int(data, (prefix + "_p50_ns").c_str(), (long long)latency->p50_ns);
+        obs_data_set_int(data, (prefix + "_p99_ns").c_str(), (long long)latency->p99_ns);
+        obs_data_set_int(data, (prefix + "_max_ns").c_str(), (long long)latency->max_ns);
+    }
+    return data;
+}
+
+// Proc handler: "void get_telemetry(out string json)"
+// For external tools (e.g. scripts via obs_source_get_proc_handler())
+void telemetry_proc_get(void *data, calldata_t *cd)
+{
+    auto filter = (filter_t *)data;
+
+    telemetry_sample_t samples[TELEMETRY_RING_SIZE];
+    auto count = telemetry_ring_read(&filter->telemetry, samples, TELEMETRY_RING_SIZE);
+
+    auto array = obs_data_array_create();
+    for (size_t i = 0; i < count; i++) {
+        auto item = create_sample_data(&samples[i]);
+        obs_data_array_push_back(array, item);
+        obs_data_release(item);
+    }
+
+    auto result = obs_data_create();
+    obs_data_set_string(result, "name", obs_source_get_name(filter->source));
+    obs_data_set_array(result, "samples", array);
+    calldata_set_string(cd, "json", obs_data_get_json(result));
+
+    obs_data_array_release(array);
+    obs_data_release(result);
+}
+
+// Proc handler: "void dump_latency_trace()"
+// Supervisor writes Chrome trace-event JSON into module config directory (See telemetry_dump_trace())
+void telemetry_proc_dump_trace(void *data, calldata_t *)
+{
+    auto filter = (filter_t *)data;
+    filter->supervise_events.fetch_or(SUPERVISE_EVENT_TRACE, std::memory_order_release);
+}
+
+void telemetry_filter_renamed(void *data, calldata_t *cd)
+{
+    metrics_rename(data, calldata_string(cd, "new_name"));
+}
+
+void telemetry_register(filter_t *filter)
+{
+    auto proc = obs_source_get_proc_handler(filter->source);
+    proc_handler_add(proc, "void get_telemetry(out string json)", telemetry_proc_get, filter);
+    proc_handler_add(proc, "void dump_latency_trace()", telemetry_proc_dump_trace, filter);
+
+    // Publish to metrics server
+    metrics_register(
+        filter, &filter->telemetry, obs_source_get_name(filter->source), obs_source_get_uuid(filter->source)
+    );
+    signal_handler_connect(obs_source_get_signal_handler(filter->source), "rename", telemetry_filter_renamed, filter);
+}
+
+void telemetry_unregister(filter_t *filter)
+{
+    signal_handler_disconnect(
+        obs_source_get_signal_handler(filter->source), "rename", telemetry_filter_renamed, filter
+    );
+    metrics_unregister(filter);
+}
+
+// Metrics server is disabled unless enabled in config file (See METRICS_JSON_NAME)
+void telemetry_start_metrics_server()
+{
+    auto path = obs_module_get_config_path(obs_current_module(), METRICS_JSON_NAME);
+    auto config = obs_data_create_from_json_file(path);
+
+    if (!config) {
+        // Write default config for discoverability
+        config = obs_data_create();
+        obs_data_set_bool(config, "enabled", false);
+        obs_data_set_string(config, "bind", METRICS_DEFAULT_BIND);
+        obs_data_set_int(config, "port", METRICS_DEFAULT_PORT);
+
+        auto config_dir_path = obs_module_get_config_path(obs_current_module(), "");
+        os_mkdirs(config_dir_path);
+        bfree(config_dir_path);
+        obs_data_save_json_safe(config, path, "tmp", "bak");
+    }
+    bfree(path);
+
+    obs_data_set_default_string(config, "bind", METRICS_DEFAULT_BIND);
+    obs_data_set_default_int(config, "port", METRICS_DEFAULT_PORT);
+
+    if (obs_data_get_bool(config, "enabled")) {
+        metrics_server_start(obs_data_get_string(config, "bind"), (uint16_t)obs_data_get_int(config, "port"));
+    }
+
+    obs_data_release(config);
+}
+
+void telemetry_stop_metrics_server()
+{
+    metrics_server_stop();
+}
+
+// Latency tracing is disabled unless enabled in config file (See LATENCY_TRACE_JSON_NAME)
+// NOTE: Applied to encoder groups which are created after loading.
+void telemetry_load_tracing()
+{
+    auto path = obs_module_get_config_path(obs_current_module(), LATENCY_TRACE_JSON_NAME);
+    auto config = obs_data_create_from_json_file(path);
+
+    if (!config) {
+        // Write default config for discoverability
+        config = obs_data_create();
+        obs_data_set_bool(config, "enabled", false);
+        obs_data_set_int(config, "sample_interval", LATENCY_TRACE_DEFAULT_SAMPLE_INTERVAL);
+
+        auto config_dir_path = obs_module_get_config_path(obs_current_module(), "");
+        os_mkdirs(config_dir_path);
+        bfree(config_dir_path);
+        obs_data_save_json_safe(config, path, "tmp", "bak");
+    }
+    bfree(path);
+
+    obs_data_set_default_int(config, "sample_interval", LATENCY_TRACE_DEFAULT_SAMPLE_INTERVAL);
+
+    auto enabled = obs_data_get_bool(config, "enabled");
+    auto sample_interval = (uint32_t)obs_data_get_int(config, "sample_interval");
+    latency_trace_configure(enabled, sample_interval);
+    if (enabled) {
+        obs_log(LOG_INFO, "Latency tracing enabled (Every %u frames or audio chunks)", sample_interval);
+    }
+
+    obs_data_release(config);
+}
+
+// NOTE: Called by supervisor only while no output job is running (Encoders are stable).
+void telemetry_dump_trace(filter_t *filter)
+{
+    auto name = obs_source_get_name(filter->source);
+    if (!latency_trace_enabled() || !filter->encoders) {
+        obs_log(LOG_WARNING, "%s: No latency trace (Tracing disabled or output not started)", name);
+        return;
+    }
+
+    auto json = latency_trace_dump(&filter->encoders->latency_trace, name);
+
+    auto dir_path = obs_module_get_config_path(obs_current_module(), "traces");
+    os_mkdirs(dir_path);
+    bfree(dir_path);
+
+    auto file_name = std::string("traces/") + obs_source_get_uuid(filter->source) + ".json";
+    auto path = obs_module_get_config_path(obs_current_module(), file_name.c_str());
+    if (os_quick_write_utf8_file(path, json.c_str(), json.size(), false)) {
+        obs_log(LOG_INFO, "%s: Latency trace written to %s", name, path);
+    } else {
+        obs_log(LOG_ERROR, "%s: Writing latency trace failed: %s", name, path);
+    }
+    bfree(path);
+}
+
+// Write summary of latest sample to the log
+void telemetry_log_summary(filter_t *filter)
+{
+    telemetry_sample_t sample;
+    if (!telemetry_ring_read(&filter->telemetry, &sample, 1)) {
+        return;
+    }
+
+    obs_log(
+        LOG_INFO,
+        "%s: Telemetry: audio pushed=%llu popped=%llu overruns=%llu underruns=%llu, video frames=%u skipped=%u, "
+        "sent=%llu bytes dropped=%d",
+        obs_source_get_name(filter->source), (unsigned long long)sample.audio_frames_pushed,
+        (unsigned long long)sample.audio_frames_popped, (unsigned long long)sample.audio_overruns,
+        (unsigned long long)sample.audio_underruns, sample.video_frames_total, sample.video_frames_skipped,
+        (unsigned long long)sample.bytes_sent, sample.frames_dropped
+    );
+}
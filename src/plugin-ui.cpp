@@ -22,20 +22,8 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/dstr.h>
 #include <plugin-support.h>
 #include "plugin-main.hpp"
-
-inline bool encoder_available(const char *encoder)
-{
-    const char *val;
-    int i = 0;
-
-    while (obs_enum_encoder_types(i++, &val)) {
-        if (strcmp(val, encoder) == 0) {
-            return true;
-        }
-    }
-
-    return false;
-}
+#include "encoder/encoder-pool.hpp"
+#include "ui/properties-cache.hpp"
 
 inline void apply_defaults(obs_data_t *dest, obs_data_t *src)
 {
@@ -111,63 +99,61 @@ inline void add_plugin_info(obs_properties_t *props)
     bfree(plugin_info_text);
 }
 
+// Coerce the other color setting when the combination is invalid, so the user's latest choice wins
+bool color_settings_changed(void *param, obs_properties_t *, obs_property_t *prop, obs_data_t *settings)
+{
+    auto filter = (filter_t *)param;
+
+    obs_video_info ovi = {0};
+    if (!obs_get_video_info(&ovi)) {
+        return false;
+    }
+
+    auto format_setting = (int)obs_data_get_int(settings, "output_format");
+    auto colorspace_setting = (int)obs_data_get_int(settings, "output_colorspace");
+    auto format = format_setting == VIEW_CACHE_CANVAS ? ovi.output_format : (video_format)format_setting;
+    auto colorspace = colorspace_setting == VIEW_CACHE_CANVAS ? ovi.colorspace : (video_colorspace)colorspace_setting;
+
+    if (view_cache_color_valid(format, colorspace)) {
+        return false;
+    }
+
+    if (!strcmp(obs_property_name(prop), "output_format")) {
+        // 8-bit format was chosen -> SDR
+        obs_log(
+            LOG_WARNING, "%s: HDR color space needs 10-bit color format, use Rec. 709",
+            obs_source_get_name(filter->source)
+        );
+        obs_data_set_int(settings, "output_colorspace", VIDEO_CS_709);
+    } else {
+        // HDR color space was chosen -> 10-bit
+        obs_log(
+            LOG_WARNING, "%s: HDR color space needs 10-bit color format, use P010", obs_source_get_name(filter->source)
+        );
+        obs_data_set_int(settings, "output_format", VIDEO_FORMAT_P010);
+    }
+    return true;
+}
+
 bool audio_encoder_changed(void *param, obs_properties_t *props, obs_property_t *, obs_data_t *settings)
 {
     auto filter = (filter_t *)param;
     obs_log(LOG_DEBUG, "%s: Audio encoder chainging.", obs_source_get_name(filter->source));
 
     const auto encoder_id = obs_data_get_string(settings, "audio_encoder");
-    const auto encoder_props = obs_get_encoder_properties(encoder_id);
-    const auto encoder_bitrate_prop = obs_properties_get(encoder_props, "bitrate");
-    obs_properties_destroy(encoder_props);
 
     auto audio_encoder_group = obs_property_group_content(obs_properties_get(props, "audio_encoder_group"));
     auto audio_bitrate_prop = obs_properties_get(audio_encoder_group, "audio_bitrate");
 
     obs_property_list_clear(audio_bitrate_prop);
 
-    const auto type = obs_property_get_type(encoder_bitrate_prop);
-    auto result = true;
-    switch (type) {
-    case OBS_PROPERTY_INT: {
-        const auto max_value = obs_property_int_max(encoder_bitrate_prop);
-        const auto step_value = obs_property_int_step(encoder_bitrate_prop);
-
-        for (int i = obs_property_int_min(encoder_bitrate_prop); i <= max_value; i += step_value) {
-            char bitrateTitle[6];
-            snprintf(bitrateTitle, sizeof(bitrateTitle), "%d", i);
-            obs_property_list_add_int(audio_bitrate_prop, bitrateTitle, i);
-        }
-
-        break;
-    }
-
-    case OBS_PROPERTY_LIST: {
-        const auto format = obs_property_list_format(encoder_bitrate_prop);
-        if (format != OBS_COMBO_FORMAT_INT) {
-            obs_log(
-                LOG_ERROR, "%s: Invalid bitrate property given by encoder: %s", obs_source_get_name(filter->source),
-                encoder_id
-            );
-            result = false;
-            break;
-        }
-
-        const auto count = obs_property_list_item_count(encoder_bitrate_prop);
-        for (size_t i = 0; i < count; i++) {
-            if (obs_property_list_item_disabled(encoder_bitrate_prop, i)) {
-                continue;
-            }
-            const auto bitrate = obs_property_list_item_int(encoder_bitrate_prop, i);
-            char bitrateTitle[6];
-            snprintf(bitrateTitle, sizeof(bitrateTitle), "%lld", bitrate);
-            obs_property_list_add_int(audio_bitrate_prop, bitrateTitle, bitrate);
-        }
-        break;
-    }
-
-    default:
-        break;
+    // Bitrates are cached per encoder
+    auto result = properties_cache_add_audio_bitrates(encoder_id, audio_bitrate_prop);
+    if (!result) {
+        obs_log(
+            LOG_ERROR, "%s: Invalid bitrate property given by encoder: %s", obs_source_get_name(filter->source),
+            encoder_id
+        );
     }
 
     obs_log(LOG_INFO, "%s: Audio encoder changed.", obs_source_get_name(filter->source));
@@ -184,6 +170,26 @@ bool video_encoder_changed(void *param, obs_properties_t *props, obs_property_t
 
     obs_properties_remove_by_name(video_encoder_group, "video_encoder_settings_group");
 
+    if (!strcmp(encoder_id, ENCODER_POOL_AUTO_ID)) {
+        // Actual encoder is unknown until placed, so only settings which every encoder accepts
+        auto auto_props = obs_properties_create();
+        auto bitrate_prop = obs_properties_add_int(auto_props, "bitrate", obs_module_text("BitRate"), 50, 1000000, 50);
+        obs_property_int_set_suffix(bitrate_prop, " Kbps");
+        auto keyint_prop =
+            obs_properties_add_int(auto_props, "keyint_sec", obs_module_text("KeyframeInterval"), 0, 20, 1);
+        obs_property_int_set_suffix(keyint_prop, " s");
+        obs_properties_add_group(
+            video_encoder_group, "video_encoder_settings_group", obs_module_text("VideoEncoder.Auto"), OBS_GROUP_NORMAL,
+            auto_props
+        );
+
+        obs_data_set_default_int(settings, "bitrate", 6000);
+        obs_data_set_default_int(settings, "keyint_sec", 2);
+
+        obs_log(LOG_INFO, "%s: Video encoder changed.", obs_source_get_name(filter->source));
+        return true;
+    }
+
     auto encoder_props = obs_get_encoder_properties(encoder_id);
     if (encoder_props) {
         obs_properties_add_group(
@@ -193,9 +199,7 @@ bool video_encoder_changed(void *param, obs_properties_t *props, obs_property_t
     }
 
     // Apply encoder's defaults
-    auto encoder_defaults = obs_encoder_defaults(encoder_id);
-    apply_defaults(settings, encoder_defaults);
-    obs_data_release(encoder_defaults);
+    apply_defaults(settings, properties_cache_encoder_defaults(encoder_id));
 
     obs_log(LOG_INFO, "%s: Video encoder changed.", obs_source_get_name(filter->source));
     return true;
@@ -243,9 +247,9 @@ inline const char *get_simple_video_encoder(const char *encoder)
     } else if (!strcmp(encoder, SIMPLE_ENCODER_AMD_AV1)) {
         return "av1_texture_amf";
     } else if (!strcmp(encoder, SIMPLE_ENCODER_NVENC)) {
-        return encoder_available("jim_nvenc") ? "jim_nvenc" : "ffmpeg_nvenc";
+        return properties_cache_encoder_available("jim_nvenc") ? "jim_nvenc" : "ffmpeg_nvenc";
     } else if (!strcmp(encoder, SIMPLE_ENCODER_NVENC_HEVC)) {
-        return encoder_available("jim_hevc_nvenc") ? "jim_hevc_nvenc" : "ffmpeg_hevc_nvenc";
+        return properties_cache_encoder_available("jim_hevc_nvenc") ? "jim_hevc_nvenc" : "ffmpeg_hevc_nvenc";
     } else if (!strcmp(encoder, SIMPLE_ENCODER_NVENC_AV1)) {
         return "jim_av1_nvenc";
     } else if (!strcmp(encoder, SIMPLE_ENCODER_APPLE_H264)) {
@@ -280,6 +284,29 @@ void get_defaults(obs_data_t *defaults)
     obs_data_set_default_string(defaults, "audio_encoder", audio_encoder_id);
     obs_data_set_default_string(defaults, "video_encoder", video_encoder_id);
     obs_data_set_default_int(defaults, "audio_bitrate", audio_bitrate);
+    obs_data_set_default_int(defaults, "output_height", 0);
+    obs_data_set_default_int(defaults, "scale_type", OBS_SCALE_BICUBIC);
+    obs_data_set_default_int(defaults, "frame_rate_divisor", 1);
+    obs_data_set_default_bool(defaults, "resolution_lock", false);
+    obs_data_set_default_bool(defaults, "adaptive_bitrate", false);
+    obs_data_set_default_int(defaults, "abr_min_bitrate", 1000);
+    obs_data_set_default_int(defaults, "output_format", VIEW_CACHE_CANVAS);
+    obs_data_set_default_int(defaults, "output_colorspace", VIEW_CACHE_CANVAS);
+    obs_data_set_default_int(defaults, "output_range", VIEW_CACHE_CANVAS);
+    obs_data_set_default_int(defaults, "locked_width", 1920);
+    obs_data_set_default_int(defaults, "locked_height", 1080);
+    obs_data_set_default_int(defaults, "startup_priority", 0);
+    obs_data_set_default_bool(defaults, "warm_standby", false);
+
+    // Recording follows the frontend's recording path
+    auto record_path = obs_frontend_get_current_record_output_path();
+    obs_data_set_default_bool(defaults, "recording", false);
+    obs_data_set_default_string(defaults, "rec_path", record_path ? record_path : "");
+    obs_data_set_default_string(defaults, "rec_format", "mkv");
+    obs_data_set_default_bool(defaults, "rec_split_file", false);
+    obs_data_set_default_int(defaults, "rec_split_size_mb", 2048);
+    obs_data_set_default_int(defaults, "rec_split_time_min", 15);
+    bfree(record_path);
 
     obs_log(LOG_INFO, "Default settings applied.");
 }
@@ -297,6 +324,45 @@ obs_properties_t *get_properties(void *data)
     obs_properties_add_text(stream_group, "key", obs_module_text("Key"), OBS_TEXT_PASSWORD);
     obs_properties_add_group(props, "stream", obs_module_text("Stream"), OBS_GROUP_NORMAL, stream_group);
 
+    // Additional destinations share the same encoders with primary stream
+    for (size_t i = 1; i < MAX_STREAM_DESTINATIONS; i++) {
+        char name[32], server_name[32], key_name[32], title[64];
+        snprintf(name, sizeof(name), "stream_%zu", i + 1);
+        snprintf(server_name, sizeof(server_name), "server_%zu", i + 1);
+        snprintf(key_name, sizeof(key_name), "key_%zu", i + 1);
+        snprintf(title, sizeof(title), "%s %zu", obs_module_text("Stream"), i + 1);
+
+        auto dest_group = obs_properties_create();
+        obs_properties_add_text(dest_group, server_name, obs_module_text("Server"), OBS_TEXT_DEFAULT);
+        obs_properties_add_text(dest_group, key_name, obs_module_text("Key"), OBS_TEXT_PASSWORD);
+        obs_properties_add_group(props, name, title, OBS_GROUP_CHECKABLE, dest_group);
+    }
+
+    // "Recording" group (Alongside streaming or alone when no server is given)
+    auto recording_group = obs_properties_create();
+    obs_properties_add_path(
+        recording_group, "rec_path", obs_module_text("RecordingPath"), OBS_PATH_DIRECTORY, NULL, NULL
+    );
+    auto rec_format_list = obs_properties_add_list(
+        recording_group, "rec_format", obs_module_text("RecordingFormat"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING
+    );
+    add_recording_formats(rec_format_list);
+
+    auto split_file_group = obs_properties_create();
+    obs_properties_add_int(split_file_group, "rec_split_size_mb", obs_module_text("SplitFileSize"), 0, 1048576, 1);
+    obs_properties_add_int(split_file_group, "rec_split_time_min", obs_module_text("SplitFileTime"), 0, 1440, 1);
+    obs_properties_add_group(
+        recording_group, "rec_split_file", obs_module_text("SplitFile"), OBS_GROUP_CHECKABLE, split_file_group
+    );
+
+    obs_properties_add_group(props, "recording", obs_module_text("Recording"), OBS_GROUP_CHECKABLE, recording_group);
+
+    // "Startup" group (Filters start one after another when a scene collection is loaded)
+    auto startup_group = obs_properties_create();
+    obs_properties_add_int(startup_group, "startup_priority", obs_module_text("StartupPriority"), -10, 10, 1);
+    obs_properties_add_bool(startup_group, "warm_standby", obs_module_text("WarmStandby"));
+    obs_properties_add_group(props, "startup", obs_module_text("Startup"), OBS_GROUP_NORMAL, startup_group);
+
     // "Audio" gorup
     auto audio_group = obs_properties_create();
     auto audio_source_list = obs_properties_add_list(
@@ -305,17 +371,7 @@ obs_properties_t *get_properties(void *data)
 
     obs_property_list_add_string(audio_source_list, obs_module_text("NoAudio"), "no_audio");
 
-    obs_enum_sources(
-        [](void *param, obs_source_t *source) {
-            auto prop = (obs_property_t *)param;
-            const uint32_t flags = obs_source_get_output_flags(source);
-            if (flags & OBS_SOURCE_AUDIO) {
-                obs_property_list_add_string(prop, obs_source_get_name(source), obs_source_get_uuid(source));
-            }
-            return true;
-        },
-        audio_source_list
-    );
+    properties_cache_add_audio_sources(audio_source_list);
 
     for (int i = 1; i <= MAX_AUDIO_MIXES; i++) {
         char trackTitle[] = "MasterTrack1";
@@ -342,37 +398,114 @@ obs_properties_t *get_properties(void *data)
         audio_encoder_group, "audio_bitrate", obs_module_text("AudioBitrate"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
     );
 
+    // One audio output (Thread) carries up to MAX_AUDIO_MIXES branches
+    obs_properties_add_bool(audio_encoder_group, "audio_bus", obs_module_text("AudioBus"));
+
     obs_properties_add_group(
         props, "audio_encoder_group", obs_module_text("AudioEncoder"), OBS_GROUP_NORMAL, audio_encoder_group
     );
 
+    // "Video" group (Scaling and frame rate are applied before encoding)
+    auto video_group = obs_properties_create();
+
+    auto output_height_list = obs_properties_add_list(
+        video_group, "output_height", obs_module_text("OutputResolution"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(output_height_list, obs_module_text("OutputResolution.Source"), 0);
+    for (auto height : {2160, 1440, 1080, 720, 540, 480, 360}) {
+        char heightTitle[8];
+        snprintf(heightTitle, sizeof(heightTitle), "%dp", height);
+        obs_property_list_add_int(output_height_list, heightTitle, height);
+    }
+
+    auto scale_type_list = obs_properties_add_list(
+        video_group, "scale_type", obs_module_text("ScaleFilter"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(scale_type_list, obs_module_text("ScaleFilter.Bilinear"), OBS_SCALE_BILINEAR);
+    obs_property_list_add_int(scale_type_list, obs_module_text("ScaleFilter.Bicubic"), OBS_SCALE_BICUBIC);
+    obs_property_list_add_int(scale_type_list, obs_module_text("ScaleFilter.Lanczos"), OBS_SCALE_LANCZOS);
+    obs_property_list_add_int(scale_type_list, obs_module_text("ScaleFilter.Area"), OBS_SCALE_AREA);
+
+    auto frame_rate_divisor_list = obs_properties_add_list(
+        video_group, "frame_rate_divisor", obs_module_text("FrameRateDivisor"), OBS_COMBO_TYPE_LIST,
+        OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(frame_rate_divisor_list, obs_module_text("FrameRateDivisor.None"), 1);
+    for (int divisor = 2; divisor <= 4; divisor++) {
+        char divisorTitle[8];
+        snprintf(divisorTitle, sizeof(divisorTitle), "1/%d", divisor);
+        obs_property_list_add_int(frame_rate_divisor_list, divisorTitle, divisor);
+    }
+
+    // Color format of the view (Converted on GPU before encoders receive frames)
+    auto output_format_list = obs_properties_add_list(
+        video_group, "output_format", obs_module_text("ColorFormat"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(output_format_list, obs_module_text("SameAsCanvas"), VIEW_CACHE_CANVAS);
+    obs_property_list_add_int(output_format_list, "NV12 (8-bit, 4:2:0, 2 planes)", VIDEO_FORMAT_NV12);
+    obs_property_list_add_int(output_format_list, "I420 (8-bit, 4:2:0, 3 planes)", VIDEO_FORMAT_I420);
+    obs_property_list_add_int(output_format_list, "I444 (8-bit, 4:4:4)", VIDEO_FORMAT_I444);
+    obs_property_list_add_int(output_format_list, "P010 (10-bit, 4:2:0, 2 planes)", VIDEO_FORMAT_P010);
+    obs_property_list_add_int(output_format_list, "I010 (10-bit, 4:2:0, 3 planes)", VIDEO_FORMAT_I010);
+
+    auto output_colorspace_list = obs_properties_add_list(
+        video_group, "output_colorspace", obs_module_text("ColorSpace"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(output_colorspace_list, obs_module_text("SameAsCanvas"), VIEW_CACHE_CANVAS);
+    obs_property_list_add_int(output_colorspace_list, "sRGB", VIDEO_CS_SRGB);
+    obs_property_list_add_int(output_colorspace_list, "Rec. 709", VIDEO_CS_709);
+    obs_property_list_add_int(output_colorspace_list, "Rec. 601", VIDEO_CS_601);
+    obs_property_list_add_int(output_colorspace_list, "Rec. 2100 (PQ)", VIDEO_CS_2100_PQ);
+    obs_property_list_add_int(output_colorspace_list, "Rec. 2100 (HLG)", VIDEO_CS_2100_HLG);
+
+    obs_property_set_modified_callback2(output_format_list, color_settings_changed, data);
+    obs_property_set_modified_callback2(output_colorspace_list, color_settings_changed, data);
+
+    auto output_range_list = obs_properties_add_list(
+        video_group, "output_range", obs_module_text("ColorRange"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(output_range_list, obs_module_text("SameAsCanvas"), VIEW_CACHE_CANVAS);
+    obs_property_list_add_int(output_range_list, obs_module_text("ColorRange.Partial"), VIDEO_RANGE_PARTIAL);
+    obs_property_list_add_int(output_range_list, obs_module_text("ColorRange.Full"), VIDEO_RANGE_FULL);
+
+    // Fixed canvas size which the source is letterboxed into (Source resizing never restarts encoders)
+    auto resolution_lock_group = obs_properties_create();
+    obs_properties_add_int(resolution_lock_group, "locked_width", obs_module_text("Width"), 2, 8192, 2);
+    obs_properties_add_int(resolution_lock_group, "locked_height", obs_module_text("Height"), 2, 8192, 2);
+    obs_properties_add_group(
+        video_group, "resolution_lock", obs_module_text("ResolutionLock"), OBS_GROUP_CHECKABLE, resolution_lock_group
+    );
+
+    obs_properties_add_group(props, "video_group", obs_module_text("Video"), OBS_GROUP_NORMAL, video_group);
+
     // "Video Encoder" group
     auto video_encoder_group = obs_properties_create();
 
+    // Filters on the same source which have identical settings use one encoder pair
+    obs_properties_add_bool(video_encoder_group, "share_encoders", obs_module_text("ShareEncoders"));
+
+    // Lower bitrate on congestion and raise it back up to encoder's bitrate (Encoders are never shared)
+    auto adaptive_bitrate_group = obs_properties_create();
+    auto min_bitrate_prop = obs_properties_add_int(
+        adaptive_bitrate_group, "abr_min_bitrate", obs_module_text("MinBitrate"), 50, 1000000, 50
+    );
+    obs_property_int_set_suffix(min_bitrate_prop, " Kbps");
+    obs_properties_add_group(
+        video_encoder_group, "adaptive_bitrate", obs_module_text("AdaptiveBitrate"), OBS_GROUP_CHECKABLE,
+        adaptive_bitrate_group
+    );
+
     // "Video Encoder" prop
     auto video_encoder_list = obs_properties_add_list(
         video_encoder_group, "video_encoder", obs_module_text("VideoEncoder"), OBS_COMBO_TYPE_LIST,
         OBS_COMBO_FORMAT_STRING
     );
 
-    // Enum audio and video encoders
-    const char *encoder_id = NULL;
-    size_t i = 0;
-    while (obs_enum_encoder_types(i++, &encoder_id)) {
-        auto caps = obs_get_encoder_caps(encoder_id);
-        if (caps & (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL)) {
-            // Ignore deprecated and internal
-            continue;
-        }
-
-        auto name = obs_encoder_get_display_name(encoder_id);
+    // Placed on the least loaded hardware encoder by encoder pool
+    obs_property_list_add_string(video_encoder_list, obs_module_text("VideoEncoder.Auto"), ENCODER_POOL_AUTO_ID);
 
-        if (obs_get_encoder_type(encoder_id) == OBS_ENCODER_VIDEO) {
-            obs_property_list_add_string(video_encoder_list, name, encoder_id);
-        } else if (obs_get_encoder_type(encoder_id) == OBS_ENCODER_AUDIO) {
-            obs_property_list_add_string(audio_encoder_list, name, encoder_id);
-        }
-    }
+    // Enum audio and video encoders (Deprecated and internal are ignored)
+    properties_cache_add_encoders(video_encoder_list, audio_encoder_list);
 
     obs_property_set_modified_callback2(audio_encoder_list, audio_encoder_changed, data);
     obs_property_set_modified_callback2(video_encoder_list, video_encoder_changed, data);
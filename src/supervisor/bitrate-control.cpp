@@ -0,0 +1,78 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include "bitrate-control.hpp"
+
+// Update bounds without resetting the current bitrate (Clamped)
+static void bitrate_control_set_bounds(bitrate_control_t *control, uint32_t min_bitrate, uint32_t max_bitrate)
+{
+    control->max_bitrate = max_bitrate;
+    control->min_bitrate = min_bitrate < max_bitrate ? min_bitrate : max_bitrate;
+
+    if (control->bitrate > control->max_bitrate) {
+        control->bitrate = control->max_bitrate;
+    } else if (control->bitrate < control->min_bitrate) {
+        control->bitrate = control->min_bitrate;
+    }
+}
+
+void bitrate_control_reset(bitrate_control_t *control, uint32_t min_bitrate, uint32_t max_bitrate)
+{
+    *control = {0};
+    bitrate_control_set_bounds(control, min_bitrate, max_bitrate);
+    control->bitrate = control->max_bitrate;
+}
+
+int bitrate_control_step(bitrate_control_t *control, float congestion, float drop_ratio)
+{
+    if (control->hold_samples) {
+        control->hold_samples--;
+        return BITRATE_DECISION_KEPT;
+    }
+
+    auto congested = congestion >= BITRATE_CONGESTION_HIGH || drop_ratio * 100.0f > BITRATE_DROP_RATIO_PERCENT;
+
+    if (congested) {
+        control->calm_samples = 0;
+        if (control->bitrate <= control->min_bitrate) {
+            return BITRATE_DECISION_KEPT;
+        }
+
+        auto bitrate = (uint32_t)((uint64_t)control->bitrate * (100 - BITRATE_DECREASE_PERCENT) / 100);
+        control->bitrate = bitrate > control->min_bitrate ? bitrate : control->min_bitrate;
+        control->hold_samples = BITRATE_HOLD_SAMPLES;
+        return BITRATE_DECISION_LOWERED;
+    }
+
+    if (congestion >= BITRATE_CONGESTION_LOW || drop_ratio > 0.0f) {
+        control->calm_samples = 0;
+        return BITRATE_DECISION_KEPT;
+    }
+
+    control->calm_samples++;
+    if (control->calm_samples < BITRATE_CALM_SAMPLES || control->bitrate >= control->max_bitrate) {
+        return BITRATE_DECISION_KEPT;
+    }
+
+    auto step = (uint32_t)((uint64_t)control->max_bitrate * BITRATE_INCREASE_PERCENT / 100);
+    auto bitrate = control->bitrate + (step ? step : 1);
+    control->bitrate = bitrate < control->max_bitrate ? bitrate : control->max_bitrate;
+    control->calm_samples = BITRATE_CALM_SAMPLES - BITRATE_INCREASE_INTERVAL;
+    return BITRATE_DECISION_RAISED;
+}
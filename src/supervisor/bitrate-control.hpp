@@ -0,0 +1,50 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Thresholds of adaptive bitrate (Evaluated once per telemetry sample)
+#define BITRATE_CONGESTION_HIGH 0.25f   // Lower bitrate at or above
+#define BITRATE_CONGESTION_LOW 0.05f    // Consider raising bitrate below
+#define BITRATE_DROP_RATIO_PERCENT 1    // Lower bitrate when more frames were dropped
+#define BITRATE_DECREASE_PERCENT 25     // Multiplicative decrease
+#define BITRATE_INCREASE_PERCENT 5      // Additive increase (Percent of max bitrate)
+#define BITRATE_HOLD_SAMPLES 2          // Wait for the effect after decreasing
+#define BITRATE_CALM_SAMPLES 10         // Calm samples required before first increase
+#define BITRATE_INCREASE_INTERVAL 5     // Calm samples between increases
+
+#define BITRATE_DECISION_LOWERED -1
+#define BITRATE_DECISION_KEPT 0
+#define BITRATE_DECISION_RAISED 1
+
+// AIMD controller which follows output congestion and dropped frames of the worst output.
+// Bitrates are kbps and stay within [min_bitrate, max_bitrate].
+struct bitrate_control_t {
+    uint32_t bitrate;
+    uint32_t min_bitrate;
+    uint32_t max_bitrate;
+    uint32_t hold_samples;
+    uint32_t calm_samples;
+};
+
+void bitrate_control_reset(bitrate_control_t *control, uint32_t min_bitrate, uint32_t max_bitrate);
+// Feed worst congestion and drop ratio (Dropped / total frames since previous step) of outputs.
+// Returns BITRATE_DECISION_* and updates control->bitrate
+int bitrate_control_step(bitrate_control_t *control, float congestion, float drop_ratio);
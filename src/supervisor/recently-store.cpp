@@ -0,0 +1,186 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <string>
+#include "recently-store.hpp"
+
+static pthread_mutex_t store_mutex = PTHREAD_MUTEX_INITIALIZER;
+static obs_data_t *recently = nullptr; // Protected by store_mutex
+static bool loaded = false;            // Protected by store_mutex
+static bool dirty = false;             // Protected by store_mutex
+static uint64_t save_at = 0;           // Protected by store_mutex
+static bool stopping = false;          // Protected by store_mutex
+static std::string path;
+static os_event_t *store_event = nullptr;
+static pthread_t writer;
+static bool writer_running = false;
+
+inline obs_data_t *clone_data(obs_data_t *data)
+{
+    return obs_data_create_from_json(obs_data_get_json(data));
+}
+
+inline void write_file(obs_data_t *data)
+{
+    auto config_dir_path = obs_module_get_config_path(obs_current_module(), "");
+    os_mkdirs(config_dir_path);
+    bfree(config_dir_path);
+
+    if (!obs_data_save_json_safe(data, path.c_str(), "tmp", "bak")) {
+        obs_log(LOG_WARNING, "Saving recently settings failed: %s", path.c_str());
+    }
+}
+
+// Take the settings to be written (NULL if nothing is due)
+inline obs_data_t *take_pending(bool force)
+{
+    obs_data_t *data = nullptr;
+
+    pthread_mutex_lock(&store_mutex);
+    if (dirty && recently && (force || os_gettime_ns() >= save_at)) {
+        data = clone_data(recently);
+        dirty = false;
+    }
+    pthread_mutex_unlock(&store_mutex);
+
+    return data;
+}
+
+void *recently_writer_thread(void *)
+{
+    os_set_thread_name("branch-output-recently");
+
+    for (;;) {
+        pthread_mutex_lock(&store_mutex);
+        auto exit = stopping;
+        auto pending = dirty;
+        auto wait_ns = save_at > os_gettime_ns() ? save_at - os_gettime_ns() : 0;
+        pthread_mutex_unlock(&store_mutex);
+
+        if (exit) {
+            break;
+        }
+
+        if (!pending) {
+            os_event_wait(store_event);
+            continue;
+        }
+        if (wait_ns) {
+            // Wakes up on stop or another save (Which postpones the deadline)
+            os_event_timedwait(store_event, (unsigned long)(wait_ns / 1000000) + 1);
+            continue;
+        }
+
+        auto data = take_pending(false);
+        if (data) {
+            write_file(data);
+            obs_data_release(data);
+            obs_log(LOG_DEBUG, "Recently settings saved");
+        }
+    }
+
+    return nullptr;
+}
+
+void recently_store_init(const char *file_name)
+{
+    auto config_path = obs_module_get_config_path(obs_current_module(), file_name);
+    path = config_path;
+    bfree(config_path);
+
+    stopping = false;
+
+    if (os_event_init(&store_event, OS_EVENT_TYPE_AUTO) != 0) {
+        obs_log(LOG_ERROR, "Recently store event creation failed");
+        return;
+    }
+    writer_running = pthread_create(&writer, NULL, recently_writer_thread, NULL) == 0;
+}
+
+void recently_store_free()
+{
+    pthread_mutex_lock(&store_mutex);
+    stopping = true;
+    pthread_mutex_unlock(&store_mutex);
+
+    if (writer_running) {
+        os_event_signal(store_event);
+        pthread_join(writer, NULL);
+        writer_running = false;
+    }
+    if (store_event) {
+        os_event_destroy(store_event);
+        store_event = nullptr;
+    }
+
+    // Flush pending settings synchronously
+    auto data = take_pending(true);
+    if (data) {
+        write_file(data);
+        obs_data_release(data);
+    }
+
+    pthread_mutex_lock(&store_mutex);
+    obs_data_release(recently);
+    recently = nullptr;
+    loaded = false;
+    pthread_mutex_unlock(&store_mutex);
+}
+
+void recently_store_save(obs_data_t *settings)
+{
+    auto data = clone_data(settings);
+
+    pthread_mutex_lock(&store_mutex);
+    obs_data_release(recently);
+    recently = data;
+    loaded = true;
+    dirty = true;
+    save_at = os_gettime_ns() + RECENTLY_SAVE_DELAY_NS;
+    auto synchronous = !writer_running;
+    pthread_mutex_unlock(&store_mutex);
+
+    if (synchronous) {
+        // Fallback to synchronous write
+        auto pending = take_pending(true);
+        if (pending) {
+            write_file(pending);
+            obs_data_release(pending);
+        }
+        return;
+    }
+
+    os_event_signal(store_event);
+}
+
+obs_data_t *recently_store_load()
+{
+    pthread_mutex_lock(&store_mutex);
+    if (!loaded) {
+        recently = obs_data_create_from_json_file(path.c_str());
+        loaded = true;
+    }
+    auto data = recently ? clone_data(recently) : nullptr;
+    pthread_mutex_unlock(&store_mutex);
+
+    return data;
+}
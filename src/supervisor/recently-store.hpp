@@ -0,0 +1,35 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Settings must stay unchanged for this period before being written
+#define RECENTLY_SAVE_DELAY_NS 2000000000ULL
+
+// In-memory copy of the recently used settings (SETTINGS_JSON_NAME).
+// save() only replaces the copy and the writer thread flushes it once per quiet period,
+// so loading a scene collection with many filters rewrites the file once.
+void recently_store_init(const char *file_name);
+void recently_store_free(); // Flushes pending settings
+void recently_store_save(obs_data_t *settings);
+
+// Returns a copy of the latest settings (Read from the file only once), NULL if none.
+// Caller must release it.
+obs_data_t *recently_store_load();
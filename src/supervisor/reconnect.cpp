@@ -0,0 +1,70 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+#include <atomic>
+#include "reconnect.hpp"
+
+static std::atomic<long> running_reconnects(0);
+
+// xorshift64 (Quality doesn't matter, only spreading is needed)
+inline uint64_t next_random()
+{
+    static thread_local uint64_t state = 0;
+    if (!state) {
+        state = os_gettime_ns() | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+uint64_t reconnect_backoff_ns(uint32_t attempts)
+{
+    uint64_t delay_ms = RECONNECT_BASE_DELAY_MS;
+    for (uint32_t i = 0; i < attempts && delay_ms < RECONNECT_MAX_DELAY_MS; i++) {
+        delay_ms <<= 1;
+    }
+    if (delay_ms > RECONNECT_MAX_DELAY_MS) {
+        delay_ms = RECONNECT_MAX_DELAY_MS;
+    }
+
+    // Jitter: [delay / 2, delay)
+    auto half = delay_ms / 2;
+    delay_ms = half + next_random() % half;
+
+    return delay_ms * 1000000ULL;
+}
+
+bool reconnect_slot_try_acquire()
+{
+    auto running = running_reconnects.load();
+    while (running < RECONNECT_MAX_CONCURRENT) {
+        if (running_reconnects.compare_exchange_weak(running, running + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void reconnect_slot_release()
+{
+    running_reconnects.fetch_sub(1);
+}
@@ -0,0 +1,33 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Reconnect scheduling shared by all filters.
+// Delay grows exponentially with attempts and is randomized (Half to full of the delay), so destinations which
+// dropped at the same instant don't reconnect at the same instant. The number of reconnects running at once is
+// capped by slots.
+#define RECONNECT_BASE_DELAY_MS 2000
+#define RECONNECT_MAX_DELAY_MS 60000
+#define RECONNECT_MAX_CONCURRENT 2
+
+uint64_t reconnect_backoff_ns(uint32_t attempts);
+bool reconnect_slot_try_acquire();
+void reconnect_slot_release();
@@ -0,0 +1,248 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include "scene-graph.hpp"
+
+static std::atomic<uint64_t> generation(1);
+
+static pthread_mutex_t index_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::unordered_map<std::string, long> item_counts; // Source UUID -> Number of scene items
+static bool index_dirty = true;                            // Protected by index_mutex
+static uint64_t index_serial = 0;                          // Protected by index_mutex (Counts every change)
+
+inline void bump_generation()
+{
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+// Full rebuild is deferred until next query
+inline void invalidate_index()
+{
+    pthread_mutex_lock(&index_mutex);
+    index_dirty = true;
+    index_serial++;
+    pthread_mutex_unlock(&index_mutex);
+
+    bump_generation();
+}
+
+// NOTE: Called without index_mutex because scene enumeration locks libobs mutexes.
+inline std::unordered_map<std::string, long> collect_items()
+{
+    std::unordered_map<std::string, long> counts;
+
+    // Enumerates public scenes and groups
+    obs_enum_scenes(
+        [](void *param, obs_source_t *scene_source) {
+            auto scene = obs_scene_from_source(scene_source);
+            if (!scene) {
+                scene = obs_group_from_source(scene_source);
+            }
+            if (scene) {
+                obs_scene_enum_items(
+                    scene,
+                    [](obs_scene_t *, obs_sceneitem_t *item, void *param) {
+                        auto counts = (std::unordered_map<std::string, long> *)param;
+                        (*counts)[obs_source_get_uuid(obs_sceneitem_get_source(item))]++;
+                        return true;
+                    },
+                    param
+                );
+            }
+            return true;
+        },
+        &counts
+    );
+
+    return counts;
+}
+
+inline obs_source_t *get_item_source(calldata_t *cd)
+{
+    auto scene = (obs_scene_t *)calldata_ptr(cd, "scene");
+    auto item = (obs_sceneitem_t *)calldata_ptr(cd, "item");
+    if (!scene || !item || obs_obj_is_private(obs_scene_get_source(scene))) {
+        return nullptr;
+    }
+    return obs_sceneitem_get_source(item);
+}
+
+void scene_item_added(void *, calldata_t *cd)
+{
+    auto source = get_item_source(cd);
+    if (!source) {
+        return;
+    }
+
+    pthread_mutex_lock(&index_mutex);
+    if (!index_dirty) {
+        item_counts[obs_source_get_uuid(source)]++;
+    }
+    index_serial++;
+    pthread_mutex_unlock(&index_mutex);
+
+    bump_generation();
+}
+
+void scene_item_removed(void *, calldata_t *cd)
+{
+    auto source = get_item_source(cd);
+    if (!source) {
+        return;
+    }
+
+    pthread_mutex_lock(&index_mutex);
+    if (!index_dirty) {
+        auto it = item_counts.find(obs_source_get_uuid(source));
+        if (it != item_counts.end() && --it->second <= 0) {
+            item_counts.erase(it);
+        }
+    }
+    index_serial++;
+    pthread_mutex_unlock(&index_mutex);
+
+    bump_generation();
+}
+
+// Scene's signals are disconnected automatically when the scene is destroyed
+inline void watch_scene(obs_source_t *source)
+{
+    if (!obs_scene_from_source(source) && !obs_group_from_source(source)) {
+        return;
+    }
+
+    auto handler = obs_source_get_signal_handler(source);
+    signal_handler_connect(handler, "item_add", scene_item_added, nullptr);
+    signal_handler_connect(handler, "item_remove", scene_item_removed, nullptr);
+}
+
+void scene_graph_source_created(void *, calldata_t *cd)
+{
+    auto source = (obs_source_t *)calldata_ptr(cd, "source");
+    watch_scene(source);
+
+    // Loaded scenes have items which were added without "item_add" signal
+    if (obs_scene_from_source(source) || obs_group_from_source(source)) {
+        invalidate_index();
+    }
+}
+
+// Items of removed source (Or items of removed scene) may disappear without "item_remove" signal
+void scene_graph_source_removed(void *, calldata_t *)
+{
+    invalidate_index();
+}
+
+void scene_graph_source_destroyed(void *, calldata_t *cd)
+{
+    auto source = (obs_source_t *)calldata_ptr(cd, "source");
+    if (obs_scene_from_source(source) || obs_group_from_source(source)) {
+        invalidate_index();
+    }
+}
+
+void scene_graph_frontend_event(obs_frontend_event event, void *)
+{
+    switch (event) {
+    case OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED:
+    case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+    case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP:
+    case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+        invalidate_index();
+        break;
+    default:
+        break;
+    }
+}
+
+void scene_graph_watch_init()
+{
+    auto handler = obs_get_signal_handler();
+    signal_handler_connect(handler, "source_create", scene_graph_source_created, nullptr);
+    signal_handler_connect(handler, "source_remove", scene_graph_source_removed, nullptr);
+    signal_handler_connect(handler, "source_destroy", scene_graph_source_destroyed, nullptr);
+
+    // Watch scenes which already exist
+    obs_enum_scenes(
+        [](void *, obs_source_t *source) {
+            watch_scene(source);
+            return true;
+        },
+        nullptr
+    );
+
+    obs_frontend_add_event_callback(scene_graph_frontend_event, nullptr);
+    obs_log(LOG_DEBUG, "Scene graph watch started");
+}
+
+void scene_graph_watch_free()
+{
+    obs_frontend_remove_event_callback(scene_graph_frontend_event, nullptr);
+
+    auto handler = obs_get_signal_handler();
+    signal_handler_disconnect(handler, "source_create", scene_graph_source_created, nullptr);
+    signal_handler_disconnect(handler, "source_remove", scene_graph_source_removed, nullptr);
+    signal_handler_disconnect(handler, "source_destroy", scene_graph_source_destroyed, nullptr);
+
+    pthread_mutex_lock(&index_mutex);
+    item_counts.clear();
+    index_dirty = true;
+    pthread_mutex_unlock(&index_mutex);
+}
+
+bool scene_graph_contains(obs_source_t *source)
+{
+    auto uuid = obs_source_get_uuid(source);
+
+    pthread_mutex_lock(&index_mutex);
+    auto dirty = index_dirty;
+    auto serial = index_serial;
+    auto found = !dirty && item_counts.find(uuid) != item_counts.end();
+    pthread_mutex_unlock(&index_mutex);
+
+    if (!dirty) {
+        return found;
+    }
+
+    // Rebuild index (Shared with all filters)
+    auto counts = collect_items();
+    found = counts.find(uuid) != counts.end();
+
+    pthread_mutex_lock(&index_mutex);
+    if (serial == index_serial) {
+        // Nothing changed during collection
+        obs_log(LOG_DEBUG, "Scene graph index rebuilt: %zu sources", counts.size());
+        item_counts.swap(counts);
+        index_dirty = false;
+    }
+    pthread_mutex_unlock(&index_mutex);
+
+    return found;
+}
+
+uint64_t scene_graph_generation()
+{
+    return generation.load(std::memory_order_acquire);
+}
@@ -0,0 +1,32 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Index from source UUID to the number of scene items which refer the source (Public scenes and groups only).
+// It's maintained incrementally by scenes' "item_add"/"item_remove" signals and rebuilt lazily when scenes are
+// created, removed or the scene collection is changed. Queries don't walk scenes.
+void scene_graph_watch_init();
+void scene_graph_watch_free();
+bool scene_graph_contains(obs_source_t *source);
+
+// Generation counter which is incremented whenever the index is changed.
+// So filters can skip even the index lookup while the counter stays the same.
+uint64_t scene_graph_generation();
@@ -0,0 +1,96 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <map>
+#include "startup.hpp"
+
+struct startup_waiter_t {
+    long long priority;
+    uint64_t since;   // First attempt
+    uint64_t seen_at; // Latest attempt
+};
+
+static pthread_mutex_t startup_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<const void *, startup_waiter_t> waiters; // Protected by startup_mutex
+static long running_startups = 0;                        // Protected by startup_mutex
+static uint64_t last_startup_at = 0;                     // Protected by startup_mutex
+
+inline bool precedes(const startup_waiter_t &a, const startup_waiter_t &b)
+{
+    return a.priority > b.priority || (a.priority == b.priority && a.since < b.since);
+}
+
+bool startup_slot_try_acquire(const void *owner, long long priority)
+{
+    auto now = os_gettime_ns();
+
+    pthread_mutex_lock(&startup_mutex);
+
+    auto &self = waiters[owner];
+    if (!self.since) {
+        self.since = now;
+    }
+    self.priority = priority;
+    self.seen_at = now;
+
+    if (running_startups >= STARTUP_MAX_CONCURRENT || now - last_startup_at < STARTUP_STAGGER_NS) {
+        pthread_mutex_unlock(&startup_mutex);
+        return false;
+    }
+
+    for (auto it = waiters.begin(); it != waiters.end();) {
+        if (it->first == owner) {
+            it++;
+            continue;
+        }
+        if (now - it->second.seen_at > STARTUP_WAITER_TIMEOUT_NS) {
+            it = waiters.erase(it);
+            continue;
+        }
+        if (precedes(it->second, self)) {
+            // Other filter goes first
+            pthread_mutex_unlock(&startup_mutex);
+            return false;
+        }
+        it++;
+    }
+
+    waiters.erase(owner);
+    running_startups++;
+    last_startup_at = now;
+
+    pthread_mutex_unlock(&startup_mutex);
+    return true;
+}
+
+void startup_slot_release()
+{
+    pthread_mutex_lock(&startup_mutex);
+    running_startups--;
+    pthread_mutex_unlock(&startup_mutex);
+}
+
+void startup_cancel(const void *owner)
+{
+    pthread_mutex_lock(&startup_mutex);
+    waiters.erase(owner);
+    pthread_mutex_unlock(&startup_mutex);
+}
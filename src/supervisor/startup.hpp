@@ -0,0 +1,36 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Startup scheduling shared by all filters.
+// When a scene collection is loaded, every configured filter wants to start on the first video_tick().
+// Starts are staggered and capped by slots, and waiting filters start in order of priority (Higher first)
+// and then arrival.
+#define STARTUP_MAX_CONCURRENT 2
+#define STARTUP_STAGGER_NS 300000000ULL
+// Waiting filters retry at this interval instead of SUPERVISE_INTERVAL_NS
+#define STARTUP_RETRY_INTERVAL_NS 100000000ULL
+// Waiters which stopped retrying (e.g. Hidden again) are forgotten
+#define STARTUP_WAITER_TIMEOUT_NS 3000000000ULL
+
+bool startup_slot_try_acquire(const void *owner, long long priority);
+void startup_slot_release();
+void startup_cancel(const void *owner);
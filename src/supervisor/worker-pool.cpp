@@ -0,0 +1,107 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <deque>
+#include <utility>
+#include <vector>
+#include "worker-pool.hpp"
+
+static pthread_mutex_t jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::deque<std::pair<worker_job_t, void *>> jobs; // Protected by jobs_mutex
+static bool stopping = false;                            // Protected by jobs_mutex
+static os_sem_t *jobs_sem = nullptr;
+static std::vector<pthread_t> workers;
+
+void *worker_thread(void *)
+{
+    os_set_thread_name("branch-output-worker");
+
+    while (os_sem_wait(jobs_sem) == 0) {
+        pthread_mutex_lock(&jobs_mutex);
+        if (jobs.empty()) {
+            // Drain remaining jobs before exit
+            auto exit = stopping;
+            pthread_mutex_unlock(&jobs_mutex);
+            if (exit) {
+                break;
+            }
+            continue;
+        }
+        auto job = jobs.front();
+        jobs.pop_front();
+        pthread_mutex_unlock(&jobs_mutex);
+
+        job.first(job.second);
+    }
+
+    return nullptr;
+}
+
+void worker_pool_init(size_t threads)
+{
+    if (os_sem_init(&jobs_sem, 0) != 0) {
+        obs_log(LOG_ERROR, "Worker pool semaphore creation failed");
+        return;
+    }
+    stopping = false;
+
+    for (size_t i = 0; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, worker_thread, NULL) == 0) {
+            workers.push_back(thread);
+        }
+    }
+
+    obs_log(LOG_DEBUG, "Worker pool started: %zu threads", workers.size());
+}
+
+void worker_pool_free()
+{
+    pthread_mutex_lock(&jobs_mutex);
+    stopping = true;
+    pthread_mutex_unlock(&jobs_mutex);
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        os_sem_post(jobs_sem);
+    }
+    for (auto thread : workers) {
+        pthread_join(thread, NULL);
+    }
+    workers.clear();
+
+    os_sem_destroy(jobs_sem);
+    jobs_sem = nullptr;
+}
+
+void worker_pool_post(worker_job_t job, void *param)
+{
+    pthread_mutex_lock(&jobs_mutex);
+    if (workers.empty()) {
+        // Fallback to synchronous call
+        pthread_mutex_unlock(&jobs_mutex);
+        job(param);
+        return;
+    }
+    jobs.push_back(std::make_pair(job, param));
+    pthread_mutex_unlock(&jobs_mutex);
+
+    os_sem_post(jobs_sem);
+}
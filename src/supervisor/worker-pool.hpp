@@ -0,0 +1,29 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Small thread pool which runs blocking jobs (Creating encoders, connecting to services, etc.) off the graphics
+// thread. Jobs run in parallel, so callers must serialize jobs which touch the same object by themselves.
+typedef void (*worker_job_t)(void *param);
+
+void worker_pool_init(size_t threads);
+void worker_pool_free();
+void worker_pool_post(worker_job_t job, void *param);
@@ -0,0 +1,124 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <stdio.h>
+#include "latency-trace.hpp"
+
+std::atomic<bool> latency_trace_on(false);
+std::atomic<uint32_t> latency_trace_interval(LATENCY_TRACE_DEFAULT_SAMPLE_INTERVAL);
+
+void latency_trace_configure(bool enabled, uint32_t sample_interval)
+{
+    latency_trace_interval.store(sample_interval ? sample_interval : 1);
+    latency_trace_on.store(enabled);
+}
+
+const char *latency_stage_name(LatencyStage stage)
+{
+    switch (stage) {
+    case LATENCY_STAGE_VIEW:
+        return "view";
+    case LATENCY_STAGE_AUDIO_BUFFER:
+        return "audio_buffer";
+    case LATENCY_STAGE_AUDIO_CALLBACK:
+        return "audio_callback";
+    default:
+        return "unknown";
+    }
+}
+
+inline uint64_t percentile(const uint64_t *buckets, uint64_t count, double percentile)
+{
+    auto threshold = (uint64_t)((double)count * percentile);
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < LATENCY_TRACE_BUCKETS; i++) {
+        accumulated += buckets[i];
+        if (accumulated > threshold) {
+            return 2ULL << i;
+        }
+    }
+    return 2ULL << (LATENCY_TRACE_BUCKETS - 1);
+}
+
+latency_summary_t latency_trace_summarize(latency_trace_t *trace, LatencyStage stage, uint64_t *last_buckets)
+{
+    latency_summary_t summary = {0};
+    uint64_t delta[LATENCY_TRACE_BUCKETS];
+
+    auto s = &trace->stages[stage];
+    for (size_t i = 0; i < LATENCY_TRACE_BUCKETS; i++) {
+        auto value = s->buckets[i].load(std::memory_order_relaxed);
+        // Counters restart when encoders were recreated
+        delta[i] = value >= last_buckets[i] ? value - last_buckets[i] : value;
+        last_buckets[i] = value;
+
+        summary.samples += delta[i];
+        if (delta[i]) {
+            summary.max_ns = 2ULL << i;
+        }
+    }
+
+    if (summary.samples) {
+        summary.p50_ns = percentile(delta, summary.samples, 0.5);
+        summary.p99_ns = percentile(delta, summary.samples, 0.99);
+    }
+    return summary;
+}
+
+std::string latency_trace_dump(latency_trace_t *trace, const char *name)
+{
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char buffer[256];
+    auto first = true;
+
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        // One row (Thread) per stage
+        snprintf(
+            buffer, sizeof(buffer),
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",", stage, latency_stage_name((LatencyStage)stage)
+        );
+        json += buffer;
+        first = false;
+
+        auto s = &trace->stages[stage];
+        auto end = s->event_seq.load(std::memory_order_acquire);
+        auto count = end < LATENCY_TRACE_EVENTS ? end : LATENCY_TRACE_EVENTS;
+
+        for (uint64_t i = end - count; i < end; i++) {
+            auto event = &s->events[i & (LATENCY_TRACE_EVENTS - 1)];
+            auto begin = event->begin.load(std::memory_order_relaxed);
+            auto duration = event->duration.load(std::memory_order_relaxed);
+            snprintf(
+                buffer, sizeof(buffer), ",{\"name\":\"%s\",\"cat\":\"branch_output\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                "\"ts\":%.3f,\"dur\":%.3f}",
+                latency_stage_name((LatencyStage)stage), stage, (double)begin / 1000.0, (double)duration / 1000.0
+            );
+            json += buffer;
+        }
+    }
+
+    // Process name (Filter name is escaped by obs_data)
+    auto meta = obs_data_create();
+    obs_data_set_string(meta, "name", name);
+    json += std::string("],\"otherData\":") + obs_data_get_json(meta) + "}";
+    obs_data_release(meta);
+
+    return json;
+}
@@ -0,0 +1,110 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <atomic>
+#include <string>
+
+// Latency tracing is disabled unless enabled in config file
+#define LATENCY_TRACE_JSON_NAME "tracing.json"
+#define LATENCY_TRACE_DEFAULT_SAMPLE_INTERVAL 8
+// Histogram buckets of log2(ns) (Up to ~4 s)
+#define LATENCY_TRACE_BUCKETS 32
+// Latest sampled events kept per stage for trace dump (Power of 2)
+#define LATENCY_TRACE_EVENTS 256
+
+// Stages which the plugin controls
+enum LatencyStage {
+    LATENCY_STAGE_VIEW,           // View rendered the frame -> Raw frame delivered from view's video output
+    LATENCY_STAGE_AUDIO_BUFFER,   // Audio captured -> Consumed by audio_input_callback (Buffering)
+    LATENCY_STAGE_AUDIO_CALLBACK, // audio_input_callback processing
+    LATENCY_STAGE_COUNT,
+};
+
+struct latency_event_t {
+    std::atomic<uint64_t> begin; // os_gettime_ns() clock
+    std::atomic<uint64_t> duration;
+};
+
+// Each stage has single writer thread (Video or audio thread of the group).
+// Readers never block writer, so a dumped event may be torn while it's overwritten (Best effort).
+struct latency_stage_t {
+    uint64_t calls; // Writer only (Sampling counter)
+    std::atomic<uint64_t> buckets[LATENCY_TRACE_BUCKETS];
+    std::atomic<uint64_t> event_seq;
+    latency_event_t events[LATENCY_TRACE_EVENTS];
+};
+
+struct latency_trace_t {
+    latency_stage_t stages[LATENCY_STAGE_COUNT];
+};
+
+// Percentiles of samples recorded since last summary (Upper bounds of log2 buckets)
+struct latency_summary_t {
+    uint64_t samples;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+};
+
+extern std::atomic<bool> latency_trace_on;
+extern std::atomic<uint32_t> latency_trace_interval;
+
+void latency_trace_configure(bool enabled, uint32_t sample_interval);
+const char *latency_stage_name(LatencyStage stage);
+
+inline bool latency_trace_enabled()
+{
+    return latency_trace_on.load(std::memory_order_relaxed);
+}
+
+// Writer side: Returns true when this call is sampled (Every sample_interval calls)
+inline bool latency_trace_sample(latency_trace_t *trace, LatencyStage stage)
+{
+    if (!latency_trace_enabled()) {
+        return false;
+    }
+    auto interval = latency_trace_interval.load(std::memory_order_relaxed);
+    return interval && (trace->stages[stage].calls++ % interval) == 0;
+}
+
+inline void latency_trace_record(latency_trace_t *trace, LatencyStage stage, uint64_t begin, uint64_t end)
+{
+    auto s = &trace->stages[stage];
+    auto ns = end > begin ? end - begin : 0;
+
+    size_t bucket = 0;
+    while (bucket < LATENCY_TRACE_BUCKETS - 1 && (ns >> (bucket + 1))) {
+        bucket++;
+    }
+    s->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    auto seq = s->event_seq.load(std::memory_order_relaxed);
+    auto event = &s->events[seq & (LATENCY_TRACE_EVENTS - 1)];
+    event->begin.store(begin, std::memory_order_relaxed);
+    event->duration.store(ns, std::memory_order_relaxed);
+    s->event_seq.store(seq + 1, std::memory_order_release);
+}
+
+// Reader side: Caller keeps last bucket counts (Cumulative histograms are never reset, so readers don't interfere)
+latency_summary_t latency_trace_summarize(latency_trace_t *trace, LatencyStage stage, uint64_t *last_buckets);
+
+// Chrome trace-event JSON of latest sampled events (Load with chrome://tracing or Perfetto)
+std::string latency_trace_dump(latency_trace_t *trace, const char *name);
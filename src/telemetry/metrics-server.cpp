@@ -0,0 +1,417 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "metrics-server.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define close_socket closesocket
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define close_socket close
+#endif
+
+#define METRICS_REQUEST_MAX 4096
+#define METRICS_POLL_INTERVAL_USEC 500000
+
+struct metrics_entry_t {
+    const void *owner;
+    telemetry_ring_t *ring;
+    std::string name;
+    std::string uuid;
+};
+
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<metrics_entry_t> registry; // Protected by registry_mutex
+
+static socket_t listen_socket = INVALID_SOCKET;
+static pthread_t server_thread;
+static std::atomic<bool> server_running(false);
+
+void metrics_register(const void *owner, telemetry_ring_t *ring, const char *name, const char *uuid)
+{
+    pthread_mutex_lock(&registry_mutex);
+    registry.push_back({owner, ring, name, uuid});
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+void metrics_rename(const void *owner, const char *name)
+{
+    pthread_mutex_lock(&registry_mutex);
+    for (auto &entry : registry) {
+        if (entry.owner == owner) {
+            entry.name = name;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+// NOTE: The ring must be valid until this returns (Server may be reading it)
+void metrics_unregister(const void *owner)
+{
+    pthread_mutex_lock(&registry_mutex);
+    for (auto it = registry.begin(); it != registry.end(); it++) {
+        if (it->owner == owner) {
+            registry.erase(it);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+inline std::string escape_label(const std::string &value)
+{
+    std::string escaped;
+    for (auto c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// Bitrate from two latest samples
+inline double sample_kbps(const telemetry_sample_t *samples, size_t count)
+{
+    if (count < 2 || samples[1].timestamp <= samples[0].timestamp || samples[1].bytes_sent < samples[0].bytes_sent) {
+        return 0.0;
+    }
+    auto seconds = (double)(samples[1].timestamp - samples[0].timestamp) / 1000000000.0;
+    return (double)(samples[1].bytes_sent - samples[0].bytes_sent) * 8.0 / 1000.0 / seconds;
+}
+
+struct metric_def_t {
+    const char *name;
+    const char *type;
+    const char *help;
+};
+
+static const metric_def_t metric_defs[] = {
+    {"branch_output_active_destinations", "gauge", "Number of active stream outputs"},
+    {"branch_output_reconnecting_destinations", "gauge", "Number of reconnecting stream outputs"},
+    {"branch_output_bytes_sent_total", "counter", "Total bytes sent by stream outputs"},
+    {"branch_output_bitrate_kbps", "gauge", "Bitrate of stream outputs"},
+    {"branch_output_frames_dropped_total", "counter", "Frames dropped by stream outputs"},
+    {"branch_output_congestion", "gauge", "Worst congestion of stream outputs (0-1)"},
+    {"branch_output_video_frames_total", "counter", "Frames rendered by the view"},
+    {"branch_output_video_frames_skipped_total", "counter", "Frames skipped by encoder lag"},
+    {"branch_output_audio_frames_pushed_total", "counter", "Audio frames pushed into the buffer"},
+    {"branch_output_audio_frames_popped_total", "counter", "Audio frames popped from the buffer"},
+    {"branch_output_audio_overruns_total", "counter", "Audio buffer full resets"},
+    {"branch_output_audio_underruns_total", "counter", "Audio callbacks which waited for frames"},
+    {"branch_output_audio_buffer_depth_frames", "gauge", "Buffered audio frames"},
+    {"branch_output_video_bitrate_kbps", "gauge", "Video bitrate set by adaptive bitrate (0: Disabled)"},
+    {"branch_output_bitrate_decision", "gauge", "Last adaptive bitrate decision (-1: Lowered, 1: Raised)"},
+    {"branch_output_view_latency_p50_ms", "gauge", "Median latency of view render to frame delivery"},
+    {"branch_output_view_latency_p99_ms", "gauge", "99th percentile latency of view render to frame delivery"},
+    {"branch_output_audio_buffer_latency_p50_ms", "gauge", "Median latency of audio capture to consumption"},
+    {"branch_output_audio_buffer_latency_p99_ms", "gauge", "99th percentile latency of audio capture to consumption"},
+    {"branch_output_audio_callback_p50_ms", "gauge", "Median processing time of audio callback"},
+    {"branch_output_audio_callback_p99_ms", "gauge", "99th percentile processing time of audio callback"},
+};
+
+inline double metric_value(size_t index, const telemetry_sample_t *samples, size_t count)
+{
+    auto s = &samples[count - 1];
+    switch (index) {
+    case 0:
+        return s->active_destinations;
+    case 1:
+        return s->reconnecting_destinations;
+    case 2:
+        return (double)s->bytes_sent;
+    case 3:
+        return sample_kbps(samples, count);
+    case 4:
+        return s->frames_dropped;
+    case 5:
+        return s->congestion;
+    case 6:
+        return s->video_frames_total;
+    case 7:
+        return s->video_frames_skipped;
+    case 8:
+        return (double)s->audio_frames_pushed;
+    case 9:
+        return (double)s->audio_frames_popped;
+    case 10:
+        return (double)s->audio_overruns;
+    case 11:
+        return (double)s->audio_underruns;
+    case 12:
+        return (double)s->audio_buffer_depth;
+    case 13:
+        return s->video_bitrate;
+    case 14:
+        return s->bitrate_decision;
+    case 15:
+        return (double)s->latency[LATENCY_STAGE_VIEW].p50_ns / 1000000.0;
+    case 16:
+        return (double)s->latency[LATENCY_STAGE_VIEW].p99_ns / 1000000.0;
+    case 17:
+        return (double)s->latency[LATENCY_STAGE_AUDIO_BUFFER].p50_ns / 1000000.0;
+    case 18:
+        return (double)s->latency[LATENCY_STAGE_AUDIO_BUFFER].p99_ns / 1000000.0;
+    case 19:
+        return (double)s->latency[LATENCY_STAGE_AUDIO_CALLBACK].p50_ns / 1000000.0;
+    case 20:
+        return (double)s->latency[LATENCY_STAGE_AUDIO_CALLBACK].p99_ns / 1000000.0;
+    default:
+        return 0.0;
+    }
+}
+
+struct metrics_snapshot_t {
+    std::string name;
+    std::string uuid;
+    telemetry_sample_t samples[2];
+    size_t count;
+};
+
+inline std::vector<metrics_snapshot_t> take_snapshots()
+{
+    std::vector<metrics_snapshot_t> snapshots;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (auto &entry : registry) {
+        metrics_snapshot_t snapshot;
+        snapshot.name = entry.name;
+        snapshot.uuid = entry.uuid;
+        snapshot.count = telemetry_ring_read(entry.ring, snapshot.samples, 2);
+        if (snapshot.count) {
+            snapshots.push_back(snapshot);
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    return snapshots;
+}
+
+std::string render_prometheus()
+{
+    auto snapshots = take_snapshots();
+    std::string body;
+    char value[64];
+
+    for (size_t i = 0; i < sizeof(metric_defs) / sizeof(metric_defs[0]); i++) {
+        body += std::string("# HELP ") + metric_defs[i].name + " " + metric_defs[i].help + "\n";
+        body += std::string("# TYPE ") + metric_defs[i].name + " " + metric_defs[i].type + "\n";
+
+        for (auto &snapshot : snapshots) {
+            snprintf(value, sizeof(value), "%.17g", metric_value(i, snapshot.samples, snapshot.count));
+            body += std::string(metric_defs[i].name) + "{filter=\"" + escape_label(snapshot.name) + "\",uuid=\"" +
+                    escape_label(snapshot.uuid) + "\"} " + value + "\n";
+        }
+    }
+
+    return body;
+}
+
+std::string render_json()
+{
+    auto snapshots = take_snapshots();
+
+    auto array = obs_data_array_create();
+    for (auto &snapshot : snapshots) {
+        auto item = obs_data_create();
+        obs_data_set_string(item, "filter", snapshot.name.c_str());
+        obs_data_set_string(item, "uuid", snapshot.uuid.c_str());
+        for (size_t i = 0; i < sizeof(metric_defs) / sizeof(metric_defs[0]); i++) {
+            obs_data_set_double(item, metric_defs[i].name, metric_value(i, snapshot.samples, snapshot.count));
+        }
+        obs_data_array_push_back(array, item);
+        obs_data_release(item);
+    }
+
+    auto result = obs_data_create();
+    obs_data_set_array(result, "filters", array);
+    std::string body = obs_data_get_json(result);
+
+    obs_data_array_release(array);
+    obs_data_release(result);
+    return body;
+}
+
+inline void send_all(socket_t sock, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size()) {
+        auto n = send(sock, data.data() + sent, (int)(data.size() - sent), 0);
+        if (n <= 0) {
+            return;
+        }
+        sent += (size_t)n;
+    }
+}
+
+inline void send_response(socket_t sock, const char *status, const char *content_type, const std::string &body)
+{
+    char header[256];
+    snprintf(
+        header, sizeof(header),
+        "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", status, content_type,
+        body.size()
+    );
+    send_all(sock, header);
+    send_all(sock, body);
+}
+
+void handle_client(socket_t client)
+{
+    // Read request line and headers (Body is ignored)
+    char request[METRICS_REQUEST_MAX + 1];
+    size_t length = 0;
+    while (length < METRICS_REQUEST_MAX) {
+        auto n = recv(client, request + length, (int)(METRICS_REQUEST_MAX - length), 0);
+        if (n <= 0) {
+            break;
+        }
+        length += (size_t)n;
+        request[length] = '\0';
+        if (strstr(request, "\r\n\r\n")) {
+            break;
+        }
+    }
+    request[length] = '\0';
+
+    if (!strncmp(request, "GET /metrics.json ", strlen("GET /metrics.json "))) {
+        send_response(client, "200 OK", "application/json", render_json());
+    } else if (!strncmp(request, "GET /metrics ", strlen("GET /metrics "))) {
+        send_response(client, "200 OK", "text/plain; version=0.0.4", render_prometheus());
+    } else {
+        send_response(client, "404 Not Found", "text/plain", "Not Found\n");
+    }
+
+    close_socket(client);
+}
+
+void *metrics_server_thread(void *)
+{
+    os_set_thread_name("branch-output-metrics");
+
+    while (server_running.load()) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(listen_socket, &fds);
+
+        // Wake up periodically to check stop request
+        timeval timeout = {0, METRICS_POLL_INTERVAL_USEC};
+        if (select((int)listen_socket + 1, &fds, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+
+        auto client = accept(listen_socket, NULL, NULL);
+        if (client == INVALID_SOCKET) {
+            continue;
+        }
+
+        // Don't let a stuck client block the server forever
+#ifdef _WIN32
+        DWORD recv_timeout = 2000;
+#else
+        timeval recv_timeout = {2, 0};
+#endif
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char *)&recv_timeout, sizeof(recv_timeout));
+
+        handle_client(client);
+    }
+
+    return nullptr;
+}
+
+bool metrics_server_start(const char *bind_address, uint16_t port)
+{
+    if (server_running.load()) {
+        return true;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        obs_log(LOG_ERROR, "Metrics server: WSAStartup failed");
+        return false;
+    }
+#endif
+
+    listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_socket == INVALID_SOCKET) {
+        obs_log(LOG_ERROR, "Metrics server: Socket creation failed");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bind_address, &addr.sin_addr) != 1 ||
+        bind(listen_socket, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_socket, 8) != 0) {
+        obs_log(LOG_ERROR, "Metrics server: Listening on %s:%u failed", bind_address, port);
+        close_socket(listen_socket);
+        listen_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    server_running.store(true);
+    if (pthread_create(&server_thread, NULL, metrics_server_thread, NULL) != 0) {
+        server_running.store(false);
+        close_socket(listen_socket);
+        listen_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    obs_log(LOG_INFO, "Metrics server listening on http://%s:%u/metrics", bind_address, port);
+    return true;
+}
+
+void metrics_server_stop()
+{
+    if (!server_running.exchange(false)) {
+        return;
+    }
+
+    pthread_join(server_thread, NULL);
+    close_socket(listen_socket);
+    listen_socket = INVALID_SOCKET;
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    obs_log(LOG_INFO, "Metrics server stopped");
+}
@@ -0,0 +1,39 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include "telemetry.hpp"
+
+#define METRICS_JSON_NAME "metrics.json"
+#define METRICS_DEFAULT_BIND "127.0.0.1"
+#define METRICS_DEFAULT_PORT 9464
+
+// Local HTTP endpoint which serves telemetry of all filters.
+//   GET /metrics      -> Prometheus text format
+//   GET /metrics.json -> JSON
+// Served from a dedicated thread. It reads only telemetry rings (Lock-free) and the registry,
+// so scraping never touches UI thread, outputs or audio locks.
+bool metrics_server_start(const char *bind_address, uint16_t port);
+void metrics_server_stop();
+
+// Registry of telemetry rings (Owner is the filter)
+void metrics_register(const void *owner, telemetry_ring_t *ring, const char *name, const char *uuid);
+void metrics_rename(const void *owner, const char *name);
+void metrics_unregister(const void *owner);
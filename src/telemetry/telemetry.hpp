@@ -0,0 +1,122 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <atomic>
+#include "latency-trace.hpp"
+
+// Number of samples kept per filter (Power of 2)
+#define TELEMETRY_RING_SIZE 64
+#define TELEMETRY_SAMPLE_INTERVAL_NS 1000000000ULL
+
+// Counters updated on audio hot paths (Relaxed atomics, never lock)
+struct telemetry_audio_t {
+    std::atomic<uint64_t> frames_pushed; // Producer: audio_filter_callback
+    std::atomic<uint64_t> frames_popped; // Consumer: audio_input_callback
+    std::atomic<uint64_t> overruns;      // Buffer full resets
+    std::atomic<uint64_t> underruns;     // Callbacks which output silence while waiting for frames
+    std::atomic<uint64_t> buffer_depth;  // Buffered frames at last callback
+};
+
+#define TELEMETRY_MAX_DESTINATIONS 4
+
+struct telemetry_destination_t {
+    bool configured;
+    bool active;
+    bool reconnecting;
+    uint64_t bytes_sent;
+    int32_t total_frames;
+    int32_t frames_dropped;
+};
+
+// Snapshot of counters and output statistics
+struct telemetry_sample_t {
+    uint64_t timestamp; // os_gettime_ns()
+
+    // Audio
+    uint64_t audio_frames_pushed;
+    uint64_t audio_frames_popped;
+    uint64_t audio_overruns;
+    uint64_t audio_underruns;
+    uint64_t audio_buffer_depth;
+
+    // Video (Skipped frames mean encoder lag)
+    uint32_t video_frames_total;
+    uint32_t video_frames_skipped;
+
+    // Stream outputs (Total of all destinations)
+    uint64_t bytes_sent;
+    int32_t frames_dropped;
+    float congestion; // Worst destination (0.0 - 1.0)
+    uint32_t active_destinations;
+    uint32_t reconnecting_destinations;
+
+    // Adaptive bitrate (Zero bitrate when disabled)
+    uint32_t video_bitrate;   // kbps
+    int32_t bitrate_decision; // BITRATE_DECISION_*
+    telemetry_destination_t destinations[TELEMETRY_MAX_DESTINATIONS];
+    telemetry_destination_t recording; // Not included in totals
+
+    // Latency tracing (Zero samples when disabled)
+    latency_summary_t latency[LATENCY_STAGE_COUNT];
+};
+
+// Time-series ring of samples. Single writer (Supervisor), any number of readers which never block writer.
+// Reader copies samples then checks the writer didn't lap them.
+struct telemetry_ring_t {
+    telemetry_sample_t samples[TELEMETRY_RING_SIZE];
+    std::atomic<uint64_t> write_seq;
+};
+
+inline void telemetry_count(std::atomic<uint64_t> &counter, uint64_t value = 1)
+{
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline void telemetry_ring_push(telemetry_ring_t *ring, const telemetry_sample_t *sample)
+{
+    auto seq = ring->write_seq.load(std::memory_order_relaxed);
+    ring->samples[seq & (TELEMETRY_RING_SIZE - 1)] = *sample;
+    ring->write_seq.store(seq + 1, std::memory_order_release);
+}
+
+// Copy latest samples (Oldest first) and returns number of copied samples.
+inline size_t telemetry_ring_read(telemetry_ring_t *ring, telemetry_sample_t *out, size_t max_samples)
+{
+    if (max_samples > TELEMETRY_RING_SIZE - 1) {
+        // Keep one slot for the writer
+        max_samples = TELEMETRY_RING_SIZE - 1;
+    }
+
+    for (;;) {
+        auto end = ring->write_seq.load(std::memory_order_acquire);
+        auto count = (size_t)(end < max_samples ? end : max_samples);
+
+        for (size_t i = 0; i < count; i++) {
+            out[i] = ring->samples[(end - count + i) & (TELEMETRY_RING_SIZE - 1)];
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring->write_seq.load(std::memory_order_relaxed) - end < TELEMETRY_RING_SIZE - count) {
+            // The writer didn't overwrite copied slots
+            return count;
+        }
+    }
+}
@@ -0,0 +1,258 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "properties-cache.hpp"
+
+struct cached_audio_source_t {
+    std::string name;
+    std::string uuid;
+};
+
+struct cached_encoder_t {
+    std::string id;
+    std::string name;
+    obs_encoder_type type;
+    bool hidden; // Deprecated or internal
+};
+
+struct cached_audio_bitrates_t {
+    bool valid;
+    std::vector<long long> bitrates;
+};
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<cached_audio_source_t> audio_sources; // Protected by cache_mutex
+static bool audio_sources_dirty = true;                   // Protected by cache_mutex
+static uint64_t audio_sources_serial = 0;                 // Protected by cache_mutex (Counts every change)
+
+// Encoder types are immutable once loaded (get_defaults() may run on other threads)
+static pthread_mutex_t encoders_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<cached_encoder_t> encoders;
+static bool encoders_loaded = false; // Protected by encoders_mutex
+
+// Accessed by UI thread only
+static std::unordered_map<std::string, cached_audio_bitrates_t> audio_bitrates;
+static std::unordered_map<std::string, obs_data_t *> encoder_defaults;
+
+// Full rebuild is deferred until properties are opened next time
+void properties_cache_source_changed(void *, calldata_t *)
+{
+    pthread_mutex_lock(&cache_mutex);
+    audio_sources_dirty = true;
+    audio_sources_serial++;
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+// NOTE: Called without cache_mutex because source enumeration locks libobs mutexes.
+inline std::vector<cached_audio_source_t> collect_audio_sources()
+{
+    std::vector<cached_audio_source_t> sources;
+
+    obs_enum_sources(
+        [](void *param, obs_source_t *source) {
+            auto list = (std::vector<cached_audio_source_t> *)param;
+            if (obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO) {
+                list->push_back({obs_source_get_name(source), obs_source_get_uuid(source)});
+            }
+            return true;
+        },
+        &sources
+    );
+
+    return sources;
+}
+
+inline void load_encoders()
+{
+    pthread_mutex_lock(&encoders_mutex);
+    if (encoders_loaded) {
+        pthread_mutex_unlock(&encoders_mutex);
+        return;
+    }
+
+    const char *encoder_id = NULL;
+    size_t i = 0;
+    while (obs_enum_encoder_types(i++, &encoder_id)) {
+        auto caps = obs_get_encoder_caps(encoder_id);
+        auto name = obs_encoder_get_display_name(encoder_id);
+        encoders.push_back(
+            {encoder_id, name ? name : encoder_id, obs_get_encoder_type(encoder_id),
+             (caps & (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL)) != 0}
+        );
+    }
+
+    encoders_loaded = true;
+    pthread_mutex_unlock(&encoders_mutex);
+    obs_log(LOG_DEBUG, "Properties cache: %zu encoder types", encoders.size());
+}
+
+inline cached_audio_bitrates_t load_audio_bitrates(const char *encoder_id)
+{
+    cached_audio_bitrates_t result = {true, {}};
+
+    auto encoder_props = obs_get_encoder_properties(encoder_id);
+    auto encoder_bitrate_prop = obs_properties_get(encoder_props, "bitrate");
+
+    switch (obs_property_get_type(encoder_bitrate_prop)) {
+    case OBS_PROPERTY_INT: {
+        const auto max_value = obs_property_int_max(encoder_bitrate_prop);
+        const auto step_value = obs_property_int_step(encoder_bitrate_prop);
+
+        for (int i = obs_property_int_min(encoder_bitrate_prop); i <= max_value; i += step_value) {
+            result.bitrates.push_back(i);
+        }
+        break;
+    }
+
+    case OBS_PROPERTY_LIST: {
+        if (obs_property_list_format(encoder_bitrate_prop) != OBS_COMBO_FORMAT_INT) {
+            result.valid = false;
+            break;
+        }
+
+        const auto count = obs_property_list_item_count(encoder_bitrate_prop);
+        for (size_t i = 0; i < count; i++) {
+            if (obs_property_list_item_disabled(encoder_bitrate_prop, i)) {
+                continue;
+            }
+            result.bitrates.push_back(obs_property_list_item_int(encoder_bitrate_prop, i));
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    obs_properties_destroy(encoder_props);
+    return result;
+}
+
+void properties_cache_init()
+{
+    auto handler = obs_get_signal_handler();
+    signal_handler_connect(handler, "source_create", properties_cache_source_changed, nullptr);
+    signal_handler_connect(handler, "source_destroy", properties_cache_source_changed, nullptr);
+    signal_handler_connect(handler, "source_rename", properties_cache_source_changed, nullptr);
+}
+
+void properties_cache_free()
+{
+    auto handler = obs_get_signal_handler();
+    signal_handler_disconnect(handler, "source_create", properties_cache_source_changed, nullptr);
+    signal_handler_disconnect(handler, "source_destroy", properties_cache_source_changed, nullptr);
+    signal_handler_disconnect(handler, "source_rename", properties_cache_source_changed, nullptr);
+
+    pthread_mutex_lock(&cache_mutex);
+    audio_sources.clear();
+    audio_sources_dirty = true;
+    pthread_mutex_unlock(&cache_mutex);
+
+    for (auto &it : encoder_defaults) {
+        obs_data_release(it.second);
+    }
+    encoder_defaults.clear();
+    audio_bitrates.clear();
+    pthread_mutex_lock(&encoders_mutex);
+    encoders.clear();
+    encoders_loaded = false;
+    pthread_mutex_unlock(&encoders_mutex);
+}
+
+void properties_cache_add_audio_sources(obs_property_t *list)
+{
+    pthread_mutex_lock(&cache_mutex);
+    auto dirty = audio_sources_dirty;
+    auto serial = audio_sources_serial;
+    pthread_mutex_unlock(&cache_mutex);
+
+    if (dirty) {
+        auto sources = collect_audio_sources();
+
+        pthread_mutex_lock(&cache_mutex);
+        audio_sources = std::move(sources);
+        // Keep dirty when sources were changed while collecting
+        audio_sources_dirty = audio_sources_serial != serial;
+        pthread_mutex_unlock(&cache_mutex);
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+    for (auto &source : audio_sources) {
+        obs_property_list_add_string(list, source.name.c_str(), source.uuid.c_str());
+    }
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+void properties_cache_add_encoders(obs_property_t *video_list, obs_property_t *audio_list)
+{
+    load_encoders();
+
+    for (auto &encoder : encoders) {
+        if (encoder.hidden) {
+            continue;
+        }
+        if (encoder.type == OBS_ENCODER_VIDEO) {
+            obs_property_list_add_string(video_list, encoder.name.c_str(), encoder.id.c_str());
+        } else if (encoder.type == OBS_ENCODER_AUDIO) {
+            obs_property_list_add_string(audio_list, encoder.name.c_str(), encoder.id.c_str());
+        }
+    }
+}
+
+bool properties_cache_encoder_available(const char *encoder_id)
+{
+    load_encoders();
+
+    for (auto &encoder : encoders) {
+        if (encoder.id == encoder_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool properties_cache_add_audio_bitrates(const char *encoder_id, obs_property_t *list)
+{
+    auto it = audio_bitrates.find(encoder_id);
+    if (it == audio_bitrates.end()) {
+        it = audio_bitrates.emplace(encoder_id, load_audio_bitrates(encoder_id)).first;
+    }
+
+    for (auto bitrate : it->second.bitrates) {
+        char bitrateTitle[8];
+        snprintf(bitrateTitle, sizeof(bitrateTitle), "%lld", bitrate);
+        obs_property_list_add_int(list, bitrateTitle, bitrate);
+    }
+
+    return it->second.valid;
+}
+
+obs_data_t *properties_cache_encoder_defaults(const char *encoder_id)
+{
+    auto it = encoder_defaults.find(encoder_id);
+    if (it == encoder_defaults.end()) {
+        it = encoder_defaults.emplace(encoder_id, obs_encoder_defaults(encoder_id)).first;
+    }
+    return it->second;
+}
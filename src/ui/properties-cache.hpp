@@ -0,0 +1,36 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Module level cache of what get_properties() lists, so opening properties doesn't walk every source and encoder.
+// Audio sources are rebuilt lazily after "source_create"/"source_destroy"/"source_rename" signals.
+// Encoder types never change after modules are loaded, so they are enumerated only once.
+void properties_cache_init();
+void properties_cache_free();
+
+void properties_cache_add_audio_sources(obs_property_t *list);
+void properties_cache_add_encoders(obs_property_t *video_list, obs_property_t *audio_list);
+bool properties_cache_encoder_available(const char *encoder_id);
+
+// Returns false when encoder's bitrate property is invalid
+bool properties_cache_add_audio_bitrates(const char *encoder_id, obs_property_t *list);
+// Returned data is owned by cache (DO NOT release)
+obs_data_t *properties_cache_encoder_defaults(const char *encoder_id);
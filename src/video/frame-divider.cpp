@@ -0,0 +1,107 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <media-io/video-frame.h>
+#include <string>
+#include "frame-divider.hpp"
+
+struct frame_divider_t {
+    std::string name;
+    video_t *source;
+    video_t *output;
+    enum video_format format;
+    uint32_t height;
+    uint32_t divisor;
+    uint64_t counter; // Source video thread only
+};
+
+// Runs on the source video output thread
+static void divider_frame(void *param, video_data *frame)
+{
+    auto divider = (frame_divider_t *)param;
+    if (divider->counter++ % divider->divisor) {
+        return;
+    }
+
+    video_frame output_frame;
+    if (!video_output_lock_frame(divider->output, &output_frame, 1, frame->timestamp)) {
+        // Encoders are behind -> Skip (Same as libobs video output)
+        return;
+    }
+
+    video_frame input_frame;
+    memcpy(input_frame.data, frame->data, sizeof(input_frame.data));
+    memcpy(input_frame.linesize, frame->linesize, sizeof(input_frame.linesize));
+    video_frame_copy(&output_frame, &input_frame, divider->format, divider->height);
+
+    video_output_unlock_frame(divider->output);
+}
+
+frame_divider_t *frame_divider_create(video_t *source, uint32_t divisor, const char *name)
+{
+    auto source_info = video_output_get_info(source);
+    if (!source_info || divisor < 2) {
+        return nullptr;
+    }
+
+    auto divider = new frame_divider_t();
+    divider->name = name;
+    divider->source = source;
+    divider->format = source_info->format;
+    divider->height = source_info->height;
+    divider->divisor = divisor;
+
+    video_output_info info = *source_info;
+    info.name = divider->name.c_str();
+    info.fps_den *= divisor;
+
+    if (video_output_open(&divider->output, &info) != VIDEO_OUTPUT_SUCCESS) {
+        obs_log(LOG_ERROR, "%s: Opening divided video output failed", name);
+        delete divider;
+        return nullptr;
+    }
+
+    if (!video_output_connect(source, NULL, divider_frame, divider)) {
+        obs_log(LOG_ERROR, "%s: Connecting divided video output failed", name);
+        video_output_close(divider->output);
+        delete divider;
+        return nullptr;
+    }
+
+    obs_log(LOG_DEBUG, "%s: Video frames are divided by %u", name, divisor);
+    return divider;
+}
+
+// NOTE: Call after encoders on the divided output were released.
+void frame_divider_destroy(frame_divider_t *divider)
+{
+    if (!divider) {
+        return;
+    }
+
+    video_output_disconnect(divider->source, divider_frame, divider);
+    video_output_close(divider->output);
+    delete divider;
+}
+
+video_t *frame_divider_get_video(frame_divider_t *divider)
+{
+    return divider->output;
+}
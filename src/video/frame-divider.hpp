@@ -0,0 +1,30 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Frame skipping for libobs without obs_encoder_set_frame_rate_divisor() (Before 30.2).
+// Forwards every Nth frame of the source video output to a private output running at (source fps / N).
+// Frames keep their capture timestamps, so encoders on the private output stay in real time.
+struct frame_divider_t;
+
+frame_divider_t *frame_divider_create(video_t *source, uint32_t divisor, const char *name);
+void frame_divider_destroy(frame_divider_t *divider);
+video_t *frame_divider_get_video(frame_divider_t *divider);
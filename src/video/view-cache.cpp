@@ -0,0 +1,193 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/threading.h>
+#include <graphics/vec2.h>
+#include <map>
+#include <string>
+#include "view-cache.hpp"
+
+struct view_cache_t {
+    std::string key;
+    long refs; // Protected by views_mutex
+
+    obs_view_t *view;
+    video_t *video_output;
+    obs_scene_t *letterbox_scene; // Private scene which contains the parent source (Letterbox only)
+};
+
+static pthread_mutex_t views_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string, view_cache_t *> views;
+
+inline void destroy_view(view_cache_t *view)
+{
+    if (view->view) {
+        obs_view_set_source(view->view, 0, NULL);
+        obs_view_remove(view->view);
+        obs_view_destroy(view->view);
+    }
+
+    if (view->letterbox_scene) {
+        obs_scene_release(view->letterbox_scene);
+    }
+
+    obs_log(LOG_DEBUG, "View destroyed: %s", view->key.c_str());
+    delete view;
+}
+
+// Scale the source inside fixed size canvas with keeping aspect ratio
+inline obs_scene_t *create_letterbox_scene(obs_source_t *parent, uint32_t width, uint32_t height, obs_scale_type scale)
+{
+    auto scene = obs_scene_create_private(obs_source_get_name(parent));
+    auto item = obs_scene_add(scene, parent);
+    if (!item) {
+        obs_scene_release(scene);
+        return nullptr;
+    }
+
+    vec2 bounds;
+    vec2_set(&bounds, (float)width, (float)height);
+    obs_sceneitem_set_bounds_type(item, OBS_BOUNDS_SCALE_INNER);
+    obs_sceneitem_set_bounds(item, &bounds);
+    obs_sceneitem_set_bounds_alignment(item, OBS_ALIGN_CENTER);
+    obs_sceneitem_set_scale_filter(item, scale);
+
+    return scene;
+}
+
+inline view_cache_t *
+create_view(const std::string &key, obs_source_t *parent, obs_video_info *ovi, const view_cache_params_t *params)
+{
+    auto view = new view_cache_t();
+    view->key = key;
+    view->refs = 1;
+
+    auto source = parent;
+    if (params->letterbox) {
+        view->letterbox_scene = create_letterbox_scene(parent, ovi->base_width, ovi->base_height, params->scale_type);
+        if (!view->letterbox_scene) {
+            obs_log(LOG_ERROR, "%s: Letterbox scene creation failed", obs_source_get_name(parent));
+            destroy_view(view);
+            return nullptr;
+        }
+        source = obs_scene_get_source(view->letterbox_scene);
+    }
+
+    // Create view and associate it with parent source
+    view->view = obs_view_create();
+    obs_view_set_source(view->view, 0, source);
+
+    view->video_output = obs_view_add2(view->view, ovi);
+    if (!view->video_output) {
+        obs_log(LOG_ERROR, "%s: Video output association failed", obs_source_get_name(parent));
+        destroy_view(view);
+        return nullptr;
+    }
+
+    obs_log(LOG_DEBUG, "View created: %s", key.c_str());
+    return view;
+}
+
+view_cache_t *view_cache_acquire(obs_source_t *parent, const view_cache_params_t *params)
+{
+    obs_video_info ovi = {0};
+    if (!obs_get_video_info(&ovi)) {
+        // Abort when no video situation
+        return nullptr;
+    }
+
+    // Scaling is done by video output, so encoders receive only needed pixels
+    ovi.base_width = params->width;
+    ovi.base_height = params->height;
+    ovi.output_width = params->output_width;
+    ovi.output_height = params->output_height;
+    // Scale type doesn't matter without scaling (Share the view regardless of it)
+    ovi.scale_type = (ovi.output_width == ovi.base_width && ovi.output_height == ovi.base_height) ? OBS_SCALE_BICUBIC
+                                                                                                   : params->scale_type;
+
+    if (params->output_format != VIEW_CACHE_CANVAS) {
+        ovi.output_format = (video_format)params->output_format;
+    }
+    if (params->colorspace != VIEW_CACHE_CANVAS) {
+        ovi.colorspace = (video_colorspace)params->colorspace;
+    }
+    if (params->range != VIEW_CACHE_CANVAS) {
+        ovi.range = (video_range_type)params->range;
+    }
+    if (!view_cache_color_valid(ovi.output_format, ovi.colorspace)) {
+        // Settings made before validation (or canvas changed since) -> Keep HDR with 10-bit format
+        obs_log(LOG_WARNING, "HDR color space with 8-bit color format, use P010: %s", obs_source_get_name(parent));
+        ovi.output_format = VIDEO_FORMAT_P010;
+    }
+
+    auto key = std::string(obs_source_get_uuid(parent)) + ":" + std::to_string(ovi.base_width) + "x" +
+               std::to_string(ovi.base_height) + ">" + std::to_string(ovi.output_width) + "x" +
+               std::to_string(ovi.output_height) + ":" + std::to_string(ovi.scale_type) + "@" +
+               std::to_string(ovi.fps_num) + "/" + std::to_string(ovi.fps_den);
+    // Views in different color formats can't be shared
+    key += ":" + std::to_string(ovi.output_format) + "/" + std::to_string(ovi.colorspace) + "/" +
+           std::to_string(ovi.range);
+    if (params->letterbox) {
+        // Letterbox scene also uses scale type
+        key += ":letterbox:" + std::to_string(params->scale_type);
+    }
+
+    pthread_mutex_lock(&views_mutex);
+
+    view_cache_t *view = nullptr;
+    auto it = views.find(key);
+    if (it != views.end()) {
+        view = it->second;
+        view->refs++;
+    } else {
+        view = create_view(key, parent, &ovi, params);
+        if (view) {
+            views[key] = view;
+        }
+    }
+
+    pthread_mutex_unlock(&views_mutex);
+
+    return view;
+}
+
+// NOTE: Encoders must have detached from the video output before release.
+void view_cache_release(view_cache_t *view)
+{
+    if (!view) {
+        return;
+    }
+
+    pthread_mutex_lock(&views_mutex);
+    auto last = --view->refs == 0;
+    if (last) {
+        views.erase(view->key);
+    }
+    pthread_mutex_unlock(&views_mutex);
+
+    if (last) {
+        destroy_view(view);
+    }
+}
+
+video_t *view_cache_get_video(view_cache_t *view)
+{
+    return view->video_output;
+}
@@ -0,0 +1,55 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+// Refcounted view shared between filters.
+// Only one view is created per (parent source UUID, size, output size, scale type, fps, format), so the parent source
+// is rendered once per frame regardless of the number of filters (and encoder groups) on it.
+// Letterbox views render the source through a private scene, so the view size never follows the source size.
+struct view_cache_t;
+
+struct view_cache_params_t {
+    uint32_t width; // Rendering size (Source size)
+    uint32_t height;
+    uint32_t output_width; // Scaled size which is handed to encoders
+    uint32_t output_height;
+    obs_scale_type scale_type;
+    bool letterbox; // Fit the source into (width x height) regardless of source size
+
+    // Color conversion is done on GPU by the view. NV12 and P010 let hardware encoders take textures directly.
+    // VIEW_CACHE_CANVAS keeps canvas's value.
+    int output_format; // video_format
+    int colorspace;    // video_colorspace
+    int range;         // video_range_type
+};
+
+#define VIEW_CACHE_CANVAS -1
+
+// PQ and HLG need a 10-bit format (Same restriction as obs-studio's video settings)
+inline bool view_cache_color_valid(video_format format, video_colorspace colorspace)
+{
+    auto hdr = colorspace == VIDEO_CS_2100_PQ || colorspace == VIDEO_CS_2100_HLG;
+    return !hdr || format == VIDEO_FORMAT_P010 || format == VIDEO_FORMAT_I010;
+}
+
+view_cache_t *view_cache_acquire(obs_source_t *parent, const view_cache_params_t *params);
+void view_cache_release(view_cache_t *view);
+video_t *view_cache_get_video(view_cache_t *view);